@@ -8,28 +8,136 @@
 
 #include "S25FL.h"
 #include <stddef.h>
-
+#include <string.h>
+
+#if defined(S25FL_CONFIG_FILE)
+#include S25FL_CONFIG_FILE
+#endif
+
+// Acceso al port: por defecto se usan los punteros a funciones cargados en
+// S25FL_InitDriver, con S25FL_STATIC_PORT se llama directamente a las funciones
+// definidas por configuracion para que el compilador las pueda expandir en linea.
+#if defined(S25FL_STATIC_PORT)
+#define S25FL_CS(state)             S25FL_PORT_CHIP_SELECT(state)
+#define S25FL_SPI_READ(buf, len)    S25FL_PORT_SPI_READ(buf, len)
+#define S25FL_SPI_WRITE(buf, len)   S25FL_PORT_SPI_WRITE(buf, len)
+#define S25FL_SPI_WRITEBYTE(data)   S25FL_PORT_SPI_WRITEBYTE(data)
+#define S25FL_DELAY(ms)             S25FL_PORT_DELAY(ms)
+#if defined(S25FL_PORT_SPI_READ_ASYNC)
+#define S25FL_SPI_READ_ASYNC(buf, len)  S25FL_PORT_SPI_READ_ASYNC(buf, len)
+#define S25FL_SPI_WAIT()            S25FL_PORT_SPI_WAIT()
+#else
+#define S25FL_SPI_READ_ASYNC(buf, len)  S25FL_PORT_SPI_READ(buf, len)
+#define S25FL_SPI_WAIT()            true
+#endif
+#if defined(S25FL_PORT_TICK)
+#define S25FL_HAS_TICK()            true
+#define S25FL_TICK()                S25FL_PORT_TICK()
+#else
+#define S25FL_HAS_TICK()            false
+#define S25FL_TICK()                0
+#endif
+#else
 static s25fl_t s25fl;
-
+static spiRead_t spiReadAsync = NULL;   // Opcional, se registra con S25FL_setAsyncRead
+static spiWait_t spiWait = NULL;
+static tickFnc_t tickFnc = NULL;        // Opcional, se registra con S25FL_setTickFnc
+
+#define S25FL_CS(state)             s25fl.chip_select_ctrl(state)
+#define S25FL_SPI_READ(buf, len)    s25fl.spi_read_fnc(buf, len)
+#define S25FL_SPI_WRITE(buf, len)   s25fl.spi_write_fnc(buf, len)
+#define S25FL_SPI_WRITEBYTE(data)   s25fl.spi_writeByte_fnc(data)
+#define S25FL_DELAY(ms)             s25fl.delay_fnc(ms)
+// Si el port no provee lectura asincronica, se lee de forma bloqueante
+#define S25FL_SPI_READ_ASYNC(buf, len)  (spiWait != NULL ? spiReadAsync(buf, len) : \
+                                        s25fl.spi_read_fnc(buf, len))
+#define S25FL_SPI_WAIT()            (spiWait != NULL ? spiWait() : true)
+// Sin base de tiempo no hay apagado automatico y el despertar siempre espera tRES
+#define S25FL_HAS_TICK()            (tickFnc != NULL)
+#define S25FL_TICK()                (tickFnc != NULL ? tickFnc() : 0)
+#endif
+
+// Geometria: con S25FL_STATIC_GEOMETRY los parametros son constantes y las
+// operaciones de limites de pagina se reducen a mascaras y desplazamientos.
+#if defined(S25FL_STATIC_GEOMETRY)
+#ifndef S25FL_STATIC_PAGESIZE
+#define S25FL_STATIC_PAGESIZE       S25FL_PAGESIZE
+#endif
+#ifndef S25FL_STATIC_ADDRSIZE
+#define S25FL_STATIC_ADDRSIZE       24
+#endif
+#ifndef S25FL_STATIC_PAGES
+#define S25FL_STATIC_PAGES          S25FL_PAGES
+#endif
+#if (S25FL_STATIC_PAGESIZE & (S25FL_STATIC_PAGESIZE - 1)) != 0
+#error "S25FL_STATIC_PAGESIZE debe ser potencia de 2"
+#endif
+#if (S25FL_STATIC_ADDRSIZE != 24) && (S25FL_STATIC_ADDRSIZE != 16)
+#error "S25FL_STATIC_ADDRSIZE debe ser 16 o 24"
+#endif
+#if (S25FL_STATIC_PAGES * S25FL_STATIC_PAGESIZE) > (1UL << S25FL_STATIC_ADDRSIZE)
+#error "La geometria supera lo que se puede direccionar con S25FL_STATIC_ADDRSIZE bits"
+#endif
+
+#define PAGE_SIZE                   ((uint32_t)S25FL_STATIC_PAGESIZE)
+#define ADDR_SIZE                   S25FL_STATIC_ADDRSIZE
+#define NUM_PAGES                   ((uint32_t)S25FL_STATIC_PAGES)
+#define TOTAL_SIZE                  (NUM_PAGES * PAGE_SIZE)
+#else
 // Parametros para una memoria de 64 Mbits
 static int32_t pagesize = 256;
 static int8_t addrsize = 24;
 static int32_t pages = 32768;
 static uint32_t totalsize; // 8 MBytes
 
+#define PAGE_SIZE                   ((uint32_t)pagesize)
+#define ADDR_SIZE                   addrsize
+#define NUM_PAGES                   ((uint32_t)pages)
+#define TOTAL_SIZE                  totalsize
+#endif
+
+// Estado del manejo de energia
+static bool poweredDown = false;
+static bool waking = false;         // Se envio el comando de despertar y no se espero tRES
+static uint32_t idleTimeout = 0;    // 0: apagado automatico deshabilitado
+static uint32_t lastActivity;
+static uint32_t powerDownTick;
+static uint32_t wakeTick;
+static s25fl_power_stats_t powerStats;
+
 static bool S25FL_waitForReady(uint32_t timeout);
+static bool S25FL_waitForReadyPolled(void);
+static void S25FL_select(void);
+static void S25FL_releasePowerDown(void);
+static void S25FL_readBegin(uint32_t address);
+static bool S25FL_pageProgramBegin(uint32_t address, uint32_t len, bool pollWel);
+static void S25FL_pageProgramEnd(bool fastquit);
+static uint32_t S25FL_ringProducer(void *ctx, uint8_t **data, uint32_t maxLen);
 
 /*************************************************************************************************
 	 *  @brief      Inicializacion del driver S25FL
      *
      *  @details    Se copian los punteros a funciones pasados por argumentos a la estructura interna
      *              del driver, la cual no puede ser accedida por el resto del programa            
+     *              Si el port o la geometria se fijan en tiempo de compilacion
+     *              (S25FL_STATIC_PORT / S25FL_STATIC_GEOMETRY) los campos
+     *              correspondientes de config se ignoran.
+     *              La cantidad de paginas se limita a lo que se alcanza con el
+     *              tamaño de direccion: con 24 bits, de la memoria de 256 Mb
+     *              solo se usan los primeros 16 MB.
+     *              Siempre se envia el comando para salir del modo de bajo
+     *              consumo y se espera tRES, ya que luego de un reset del
+     *              microcontrolador la memoria puede seguir apagada. El apagado
+     *              automatico queda deshabilitado.
      *   	
 	 *  @param		config	Estructura de configuracion para el driver.
 	 *  @return     True si se inicializo correctamente.
 ***************************************************************************************************/
 bool S25FL_InitDriver(s25fl_t config)
 {
+#if defined(S25FL_STATIC_PORT)
+    (void)config;
+#else
     if(config.chip_select_ctrl != NULL)
         s25fl.chip_select_ctrl = config.chip_select_ctrl;
     else return false;
@@ -53,8 +161,10 @@ bool S25FL_InitDriver(s25fl_t config)
     if(config.delay_fnc != NULL)
         s25fl.delay_fnc = config.delay_fnc;
     else return false;
+#endif
 
-    switch(s25fl.memory_size)
+#if !defined(S25FL_STATIC_GEOMETRY)
+    switch(config.memory_size)
     {
         case S64MB:
             pagesize = 256;
@@ -78,11 +188,65 @@ bool S25FL_InitDriver(s25fl_t config)
             return false;
             break;                    
     }
+    // Con direcciones de addrsize bits solo se alcanzan los primeros 2^addrsize bytes
+    if ((uint32_t)pages * pagesize > (1UL << addrsize))
+    {
+        pages = (1UL << addrsize) / pagesize;
+    }
     totalsize = pages * pagesize;
+#endif
+
+    // Si la memoria quedo en bajo consumo descartaria cualquier otro comando
+    S25FL_CS(CS_ENABLE);
+    S25FL_SPI_WRITEBYTE(S25FL_CMD_RPWRDDEVID);
+    S25FL_CS(CS_DISABLE);
+    S25FL_DELAY(S25FL_WAKE_DELAY);
+
+    poweredDown = false;
+    waking = false;
+    idleTimeout = 0;
+    lastActivity = S25FL_TICK();
+    memset(&powerStats, 0, sizeof(powerStats));
 
     return true;
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Registra las funciones opcionales de lectura asincronica que
+                usa S25FL_readPipelined para solapar la transferencia de un
+                fragmento con el procesamiento del anterior.
+
+    @note       Se puede llamar antes o despues de S25FL_InitDriver. Con
+                S25FL_STATIC_PORT se ignora y se usan S25FL_PORT_SPI_READ_ASYNC
+                y S25FL_PORT_SPI_WAIT.
+
+    @param[in]  readAsync
+                Inicia una lectura sin esperar a que termine.
+    @param[in]  wait
+                Espera a que termine la lectura iniciada. Si alguna de las
+                dos es NULL, las lecturas se hacen de forma bloqueante.
+*/
+/**************************************************************************/
+void S25FL_setAsyncRead(spiRead_t readAsync, spiWait_t wait)
+{
+#if defined(S25FL_STATIC_PORT)
+    (void)readAsync;
+    (void)wait;
+#else
+    if (readAsync != NULL && wait != NULL)
+    {
+        spiReadAsync = readAsync;
+        spiWait = wait;
+    }
+    else
+    {
+        spiReadAsync = NULL;
+        spiWait = NULL;
+    }
+#endif
+}
+
 /**************************************************************************/
 /*! 
     @brief      Lee el registro de estado de la memoria.
@@ -100,10 +264,10 @@ uint8_t S25FL_readStatus()
     uint8_t rxBuff[1];
 
     reg = S25FL_CMD_READSTAT1;
-    s25fl.chip_select_ctrl(CS_ENABLE);
-    s25fl.spi_writeByte_fnc(reg);
-    s25fl.spi_read_fnc(rxBuff, 1);
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    S25FL_select();
+    S25FL_SPI_WRITEBYTE(reg);
+    S25FL_SPI_READ(rxBuff, 1);
+    S25FL_CS(CS_DISABLE);
 
     status = rxBuff[0];
     return (status & (SPIFLASH_STAT_BUSY | SPIFLASH_STAT_WRTEN));
@@ -123,10 +287,10 @@ uint32_t S25FL_readDevID()
     uint8_t rxBuff[4];
 
     reg = S25FL_CMD_JEDECID;
-    s25fl.chip_select_ctrl(CS_ENABLE);
-    s25fl.spi_writeByte_fnc(reg);
-    s25fl.spi_read_fnc(rxBuff, 4);
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    S25FL_select();
+    S25FL_SPI_WRITEBYTE(reg);
+    S25FL_SPI_READ(rxBuff, 4);
+    S25FL_CS(CS_DISABLE);
 
     devId = (((uint32_t)rxBuff[0])<<16) + (((uint32_t)rxBuff[1])<<8) + ((uint32_t)rxBuff[2]);
     return devId;
@@ -146,68 +310,82 @@ void S25FL_writeEnable (bool enable)
 
     reg = enable ? S25FL_CMD_WRITEENABLE : S25FL_CMD_WRITEDISABLE;
 
-    s25fl.chip_select_ctrl(CS_ENABLE);
-    s25fl.spi_writeByte_fnc(reg);
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    S25FL_select();
+    S25FL_SPI_WRITEBYTE(reg);
+    S25FL_CS(CS_DISABLE);
 }
 
 /**************************************************************************/
 /*! 
-    @brief      Lee la cantidad de bytes especificada desde la direccion 
-                suministrada.
-
-    Esta funcion leera uno o mas bytes comenzando desde la direccion
-    suministrada.
+    @brief      Habilita CS y envia el comando de lectura seguido de la
+                direccion. Los datos se leen a continuacion mientras CS
+                permanezca habilitado.
 
     @param[in]  address
-                La direccion de 24 bits donde comenzara la lectura.
-    @param[out] *buffer
-                Puntero al buffer donde se guardaran los datos leidos.
-    @param[in]  len
-                Longitud del buffer.
+                La direccion donde comenzara la lectura.
 */
 /**************************************************************************/
-uint32_t S25FL_readBuffer (uint32_t address, uint8_t *buffer, uint32_t len)
+static void S25FL_readBegin(uint32_t address)
 {
-    uint32_t a = 0, i = 0;
     uint8_t reg, txData[S25FL_MAX_ADDRESS_SIZE];
 
-    // Se chequea que la direccion sea valida
-    if (address >= totalsize)
-    {
-        return 0;
-    }
-    
-    s25fl.chip_select_ctrl(CS_ENABLE);
+    S25FL_select();
 
     reg = SPIFLASH_SPI_DATAREAD;
-    s25fl.spi_writeByte_fnc(reg);   // Se envia el comando de lectura
+    S25FL_SPI_WRITEBYTE(reg);   // Se envia el comando de lectura
 
-    if (addrsize == 24) // 24 bit addr
+    if (ADDR_SIZE == 24) // 24 bit addr
     { 
         txData[0] = (address >> 16) & 0xFF;     // address upper 8
         txData[1] = (address >> 8) & 0xFF;      // address mid 8
         txData[2] = (address) & 0xFF;           // address lower 8
 
-        s25fl.spi_write_fnc(txData, 3);     // Escribimos los 3 bytes de la direccion
+        S25FL_SPI_WRITE(txData, 3);     // Escribimos los 3 bytes de la direccion
     }
-    else // (addrsize == 16) // Se asume que la direccion es de 16 bit 
+    else // (ADDR_SIZE == 16) // Se asume que la direccion es de 16 bit 
     { 
         txData[0] = (address >> 8) & 0xFF;      // address high 8
         txData[1] = (address) & 0xFF;           // address lower 8        
 
-        s25fl.spi_write_fnc(txData, 2);     // Escribimos los 2 bytes de la direccion
+        S25FL_SPI_WRITE(txData, 2);     // Escribimos los 2 bytes de la direccion
     }
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Lee la cantidad de bytes especificada desde la direccion 
+                suministrada.
+
+    Esta funcion leera uno o mas bytes comenzando desde la direccion
+    suministrada.
+
+    @param[in]  address
+                La direccion de 24 bits donde comenzara la lectura.
+    @param[out] *buffer
+                Puntero al buffer donde se guardaran los datos leidos.
+    @param[in]  len
+                Longitud del buffer.
+*/
+/**************************************************************************/
+uint32_t S25FL_readBuffer (uint32_t address, uint8_t *buffer, uint32_t len)
+{
+    // Se chequea que la direccion sea valida
+    if (address >= TOTAL_SIZE)
+    {
+        return 0;
+    }
+    
+    S25FL_readBegin(address);
 
     // En caso de sobrepasar la capacidad maxima de la memoria, se trunca
-    if ((address+len) > totalsize) 
+    if ((address+len) > TOTAL_SIZE) 
     {
-        len = totalsize - address;
+        len = TOTAL_SIZE - address;
     }
 
-    s25fl.spi_read_fnc(buffer, len);    // Se leen los datos del puerto spi
+    S25FL_SPI_READ(buffer, len);    // Se leen los datos del puerto spi
 
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    S25FL_CS(CS_DISABLE);
 
     return len; // Se devuelve la cantidad de bytes leidos
 }
@@ -234,13 +412,38 @@ static bool S25FL_waitForReady(uint32_t timeout)
     {
       return true;
     }
-    s25fl.delay_fnc(1);
+    S25FL_DELAY(1);
     timeout--;
   }
 
   return false;
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Espera a que la memoria este lista consultando el registro de
+                estado sin demoras entre lecturas, para detectar el fin de una
+                programacion de pagina apenas ocurre. Luego de READY_POLLS
+                lecturas sigue esperando como S25FL_waitForReady.
+
+    @return     True si la flash esta lista, false si esta ocupada
+*/
+/**************************************************************************/
+static bool S25FL_waitForReadyPolled(void)
+{
+    uint32_t polls;
+
+    for (polls = 0; polls < READY_POLLS; polls++)
+    {
+        if (!(S25FL_readStatus() & SPIFLASH_STAT_BUSY))
+        {
+            return true;
+        }
+    }
+
+    return S25FL_waitForReady(READY_TIMEOUT);
+}
+
 /**************************************************************************/
 /*! 
     @brief      Borra el contenido de un sector de la flash.
@@ -254,7 +457,7 @@ bool S25FL_eraseSector (uint32_t sectorNumber)
     uint8_t reg, txData[S25FL_MAX_ADDRESS_SIZE];
     
     // Se chequea que sea un sector valido
-    if (sectorNumber >= S25FL_SECTORS) return false;
+    if (sectorNumber >= TOTAL_SIZE / S25FL_SECTORSIZE) return false;
 
     // Se espera hasta que el dispositivo este listo o a que se agote el tiempo de espera
     if (!S25FL_waitForReady(READY_TIMEOUT))    return false;
@@ -271,19 +474,19 @@ bool S25FL_eraseSector (uint32_t sectorNumber)
     }
 
     uint32_t address = sectorNumber * S25FL_SECTORSIZE;
-    s25fl.chip_select_ctrl(CS_ENABLE);
+    S25FL_select();
     
     // Se envia el comando para borrar el sector
     reg = S25FL_CMD_SECTERASE4;
-    s25fl.spi_writeByte_fnc(reg);
+    S25FL_SPI_WRITEBYTE(reg);
     
     txData[0] = (address >> 16) & 0xFF;     // address upper 8
     txData[1] = (address >> 8) & 0xFF;      // address mid 8
     txData[2] = (address) & 0xFF;           // address lower 8   
 
-    s25fl.spi_write_fnc(txData, 3);     // Escribimos los 3 bytes de la direccion
+    S25FL_SPI_WRITE(txData, 3);     // Escribimos los 3 bytes de la direccion
 
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    S25FL_CS(CS_DISABLE);
 
     // Se espera hasta que el dispositivo se desocupe antes de retornar.
     // Segun la hoja de datos esto puede demorar hasta 400 ms.
@@ -292,6 +495,108 @@ bool S25FL_eraseSector (uint32_t sectorNumber)
     return true;
 }
 
+/**************************************************************************/
+/*! 
+    @brief      Habilita la escritura e inicia el comando de programacion de
+                pagina, dejando CS habilitado para que a continuacion se
+                envien los datos.
+
+    @param[in]  address
+                La direccion donde comenzara la escritura.
+    @param[in]  len
+                Cantidad de bytes que se escribiran en la pagina.
+    @param[in]  pollWel
+                Si es true, en lugar de esperar 1 ms luego de habilitar la
+                escritura se lee el registro de estado hasta que se active
+                el bit de escritura.
+
+    @return     True si se inicio el comando, false si el tamaño de direccion
+                no es soportado o no se habilito la escritura.
+*/
+/**************************************************************************/
+static bool S25FL_pageProgramBegin(uint32_t address, uint32_t len, bool pollWel)
+{
+    uint8_t reg, txData[S25FL_MAX_ADDRESS_SIZE];
+    uint32_t polls;
+
+    // Se habilita la escritura
+    S25FL_select();
+    S25FL_SPI_WRITEBYTE(S25FL_CMD_WRITEENABLE);
+    S25FL_CS(CS_DISABLE);
+
+    if (pollWel)
+    {
+        for (polls = 0; !(S25FL_readStatus() & SPIFLASH_STAT_WRTEN); polls++)
+        {
+            if (polls >= READY_POLLS)   return false;
+        }
+    }
+    else
+    {
+        S25FL_DELAY(1);     // Delay para que termine de realizar el chequeo del bit de escritura
+    }
+    S25FL_select();
+
+    if (ADDR_SIZE == 24) // Se envia el comando de escritura de pagina seguido de la direccion de 24 bits
+    {       
+        reg = S25FL_CMD_PAGEPROG;
+        S25FL_SPI_WRITEBYTE(reg);
+        
+        txData[0] = (address >> 16) & 0xFF;     // address upper 8
+        txData[1] = (address >> 8) & 0xFF;      // address mid 8
+
+        if (len == PAGE_SIZE)
+        {
+            // Si la longitud es igual al tamaño de la pagina, los ultimos 8 bits
+            // deben ser 0 para que esten dentro de los limites de la pagina
+            txData[2] = 0;                      // address lower 8 
+        }
+        else
+        {
+            txData[2] = (address) & 0xFF;       // address lower 8 
+        }
+
+        S25FL_SPI_WRITE(txData, 3);         // Escribimos los 3 bytes de la direccion
+    } 
+    else if (ADDR_SIZE == 16) // Se envia el comando de escritura de pagina seguido de la direccion de 16 bits
+    {
+        reg = S25FL_CMD_PAGEPROG;
+        S25FL_SPI_WRITEBYTE(reg);
+        
+        txData[0] = (address >> 8) & 0xFF;      // address upper 8
+        txData[1] = (address) & 0xFF;           // address lower 8
+
+        S25FL_SPI_WRITE(txData, 2);         // Escribimos los 2 bytes de la direccion
+    } 
+    else 
+    {
+        S25FL_CS(CS_DISABLE);
+        return false;
+    }
+
+    return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Finaliza el comando de programacion de pagina.
+
+    @param[in]  fastquit
+                Si es true, la funcion retorna sin esperar a que el
+                dispositivo este disponible nuevamente.
+*/
+/**************************************************************************/
+static void S25FL_pageProgramEnd(bool fastquit)
+{
+    // La escritura ocurre luego de que CS se ponga en alto
+    S25FL_CS(CS_DISABLE);
+
+    if (! fastquit) {
+        // Se espera hasta que el dispositivo este listo
+        S25FL_DELAY(5);
+    }
+}
+
 /**************************************************************************/
 /*! 
     @brief      Escribe un flujo de datos continuo que automaticamente
@@ -321,7 +626,7 @@ uint32_t S25FL_writeBuffer(uint32_t address, uint8_t *buffer, uint32_t len)
     // pagina por lo que no tiene sentido duplicarlas aca.
 
     // Si los datos estan solo en una sola pagina, se escribe esa pagina directamente
-    if ((address % pagesize) + len <= pagesize)
+    if ((address % PAGE_SIZE) + len <= PAGE_SIZE)
     {
         return S25FL_writePage(address, buffer, len, false);
     }
@@ -332,7 +637,7 @@ uint32_t S25FL_writeBuffer(uint32_t address, uint8_t *buffer, uint32_t len)
     while(len)
     {
         // Se determina la cantidad de bytes necesarios a escribir en esta pagina
-        bytestowrite = pagesize - (address % pagesize);
+        bytestowrite = PAGE_SIZE - (address % PAGE_SIZE);
         // Se escribe la pagina actual
         results = S25FL_writePage(address, buffer+bufferoffset, bytestowrite, false);
         byteswritten += results;
@@ -347,7 +652,7 @@ uint32_t S25FL_writeBuffer(uint32_t address, uint8_t *buffer, uint32_t len)
         
         // Si es la ultima pagina, se escribe y se sale, si no,
         // se sigue en el loop con la proxima pagina.
-        if (len <= pagesize)
+        if (len <= PAGE_SIZE)
         {
             // Se escriben los ultimos bytes en la pagina y se sale
             results = S25FL_writePage(address, buffer+bufferoffset, len, false);
@@ -385,23 +690,20 @@ uint32_t S25FL_writeBuffer(uint32_t address, uint8_t *buffer, uint32_t len)
 /**************************************************************************/
 uint32_t S25FL_writePage (uint32_t address, uint8_t *buffer, uint32_t len, bool fastquit)
 {
-    uint8_t status;
-    uint8_t reg, txData[S25FL_MAX_ADDRESS_SIZE];
-
     // Se chequea que la direccion sea valida
-    if (address >= S25FL_MAXADDRESS)
+    if (address >= TOTAL_SIZE)
     {
         return 0;
     }
 
     // Se chequea que la longitud de los datos no supere el tamaño de la pagina
-    if (len > pagesize)
+    if (len > PAGE_SIZE)
     {
         return 0;
     }
 
     // Se chequea que los datos no sean escritos mas alla de los limites de la pagina
-    if ((address % pagesize) + len > pagesize)
+    if ((address % PAGE_SIZE) + len > PAGE_SIZE)
     {
         // Si se trata de escribir en una pagina despues del ultimo byte,
         // este dato caera al principio de la pagina, mezclandose con lo que
@@ -409,62 +711,644 @@ uint32_t S25FL_writePage (uint32_t address, uint8_t *buffer, uint32_t len, bool
         return 0;
     }
 
-    // Se habilita la escritura
-    s25fl.chip_select_ctrl(CS_ENABLE);
-    s25fl.spi_writeByte_fnc(S25FL_CMD_WRITEENABLE);
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    if (!S25FL_pageProgramBegin(address, len, false))
+    {
+        return 0;
+    }
 
-    s25fl.delay_fnc(1);     // Delay para que termine de realizar el chequeo del bit de escritura
-    s25fl.chip_select_ctrl(CS_ENABLE);
+    // Se envian los datos
+    S25FL_SPI_WRITE(buffer, len); 
 
-    if (addrsize == 24) // Se envia el comando de escritura de pagina seguido de la direccion de 24 bits
-    {       
-        reg = S25FL_CMD_PAGEPROG;
-        s25fl.spi_writeByte_fnc(reg);
-        
-        txData[0] = (address >> 16) & 0xFF;     // address upper 8
-        txData[1] = (address >> 8) & 0xFF;      // address mid 8
+    S25FL_pageProgramEnd(fastquit);
 
-        if (len == pagesize)
+    return(len);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Escribe un flujo de datos obtenido pagina por pagina desde
+                una funcion productora, sin necesidad de copiarlo antes a un
+                buffer contiguo.
+
+    Por cada pagina se inicia el comando de programacion y se le piden datos
+    al productor hasta completarla; cada fragmento entregado se envia por SPI
+    directamente desde la memoria del productor.
+
+    @note       Antes de escribir los datos, asegurarse que los sectores
+                correspondientes han sido borrados.
+
+    @param[in]  address
+                La direccion de 24 bits donde comenzara la escritura.
+    @param[in]  producer
+                Funcion que entrega el proximo fragmento de datos (de hasta
+                maxLen bytes) y devuelve su longitud, o 0 si no hay mas datos.
+    @param[in]  ctx
+                Contexto que se le pasa al productor.
+    @param[in]  len
+                Cantidad total de bytes a escribir.
+
+    @return     La cantidad de bytes escritos.
+*/
+/**************************************************************************/
+uint32_t S25FL_writeStream(uint32_t address, s25flProducer_t producer, void *ctx, uint32_t len)
+{
+    uint32_t byteswritten = 0;
+    uint32_t pagelen, remaining, chunk;
+    uint8_t *data;
+
+    if (producer == NULL || address >= TOTAL_SIZE)
+    {
+        return 0;
+    }
+
+    // En caso de sobrepasar la capacidad maxima de la memoria, se trunca.
+    // Se compara contra lo que resta para que address+len no desborde.
+    if (len > TOTAL_SIZE - address)
+    {
+        len = TOTAL_SIZE - address;
+    }
+
+    while (len)
+    {
+        // Se determina la cantidad de bytes a escribir en esta pagina
+        pagelen = PAGE_SIZE - (address % PAGE_SIZE);
+        if (pagelen > len)  pagelen = len;
+
+        if (!S25FL_pageProgramBegin(address, pagelen, false))  return byteswritten;
+
+        // Se envian los fragmentos del productor hasta completar la pagina
+        remaining = pagelen;
+        while (remaining)
         {
-            // Si la longitud es igual al tamaño de la pagina, los ultimos 8 bits
-            // deben ser 0 para que esten dentro de los limites de la pagina
-            txData[2] = 0;                      // address lower 8 
+            chunk = producer(ctx, &data, remaining);
+            if (chunk == 0 || chunk > remaining)    break;
+
+            S25FL_SPI_WRITE(data, chunk);
+            remaining -= chunk;
         }
-        else
+
+        S25FL_pageProgramEnd(false);
+
+        byteswritten += pagelen - remaining;
+
+        // Si el productor se quedo sin datos, se sale
+        if (remaining)  return byteswritten;
+
+        address += pagelen;
+        len -= pagelen;
+    }
+
+    return byteswritten;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Productor que entrega los datos de un buffer circular,
+                cortando el fragmento en el punto donde el buffer da la vuelta.
+*/
+/**************************************************************************/
+static uint32_t S25FL_ringProducer(void *ctx, uint8_t **data, uint32_t maxLen)
+{
+    s25fl_ring_t *ring = (s25fl_ring_t *)ctx;
+    uint32_t chunk;
+
+    chunk = ring->size - ring->tail;
+    if (chunk > maxLen) chunk = maxLen;
+
+    *data = ring->buffer + ring->tail;
+    ring->tail += chunk;
+    if (ring->tail >= ring->size)   ring->tail = 0;
+
+    return chunk;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Escribe datos tomados directamente de un buffer circular.
+
+    @param[in]  address
+                La direccion de 24 bits donde comenzara la escritura.
+    @param[in,out] *ring
+                Buffer circular de origen. Se leen datos a partir de tail, que
+                queda apuntando al primer byte no escrito.
+    @param[in]  len
+                Cantidad de bytes a escribir. Se limita a los que el
+                productor ya cargo, entre tail y head.
+
+    @return     La cantidad de bytes escritos.
+*/
+/**************************************************************************/
+uint32_t S25FL_writeRing(uint32_t address, s25fl_ring_t *ring, uint32_t len)
+{
+    uint32_t head, available;
+
+    if (ring == NULL || ring->buffer == NULL || ring->size == 0 || ring->tail >= ring->size)
+    {
+        return 0;
+    }
+
+    // Se lee head una sola vez, ya que el productor lo puede seguir avanzando
+    head = ring->head;
+    if (head >= ring->size) return 0;
+
+    available = (head >= ring->tail) ? head - ring->tail : ring->size - ring->tail + head;
+    if (len > available)    len = available;
+    if (len == 0)   return 0;
+
+    return S25FL_writeStream(address, S25FL_ringProducer, ring, len);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Lectura masiva con doble buffer: mientras se procesa un
+                fragmento en el callback, el siguiente ya se esta
+                transfiriendo por SPI/DMA.
+
+    Toda la region se lee con un unico comando de lectura. Si no se
+    registro una lectura asincronica con S25FL_setAsyncRead los fragmentos
+    se leen de forma bloqueante y no hay solapamiento.
+
+    @param[in]  address
+                La direccion de 24 bits donde comenzara la lectura.
+    @param[in]  len
+                Cantidad total de bytes a leer.
+    @param[in]  *bufA, *bufB
+                Buffers de chunkSize bytes que se usan alternadamente.
+    @param[in]  chunkSize
+                Tamaño de cada fragmento.
+    @param[in]  callback
+                Funcion que recibe cada fragmento leido. Si devuelve 0 se
+                interrumpe la lectura.
+    @param[in]  ctx
+                Contexto que se le pasa al callback.
+
+    @return     La cantidad de bytes entregados al callback.
+*/
+/**************************************************************************/
+uint32_t S25FL_readPipelined(uint32_t address, uint32_t len, uint8_t *bufA, uint8_t *bufB,
+                             uint32_t chunkSize, s25flChunkCallback_t callback, void *ctx)
+{
+    uint8_t *buffers[2];
+    uint32_t current, next;
+    uint32_t readlen, nextlen;
+    uint32_t bytesread = 0;
+    bool ok = true;
+
+    if (bufA == NULL || bufB == NULL || chunkSize == 0 || callback == NULL || address >= TOTAL_SIZE)
+    {
+        return 0;
+    }
+
+    // En caso de sobrepasar la capacidad maxima de la memoria, se trunca.
+    // Se compara contra lo que resta para que address+len no desborde.
+    if (len > TOTAL_SIZE - address)
+    {
+        len = TOTAL_SIZE - address;
+    }
+
+    if (len == 0)   return 0;
+
+    buffers[0] = bufA;
+    buffers[1] = bufB;
+
+    S25FL_readBegin(address);
+
+    // Se lanza la transferencia del primer fragmento
+    current = 0;
+    readlen = (len < chunkSize) ? len : chunkSize;
+    S25FL_SPI_READ_ASYNC(buffers[current], readlen);
+
+    while (readlen)
+    {
+        if (!S25FL_SPI_WAIT())  break;
+
+        // Se lanza la transferencia del proximo fragmento antes de procesar el actual
+        next = current ^ 1;
+        nextlen = len - bytesread - readlen;
+        if (nextlen > chunkSize)    nextlen = chunkSize;
+        if (nextlen)    S25FL_SPI_READ_ASYNC(buffers[next], nextlen);
+
+        ok = callback(ctx, address + bytesread, buffers[current], readlen);
+        bytesread += readlen;
+
+        if (!ok)
         {
-            txData[2] = (address) & 0xFF;       // address lower 8 
+            // Se espera a que termine la transferencia en curso antes de liberar CS
+            if (nextlen)    (void)S25FL_SPI_WAIT();
+            break;
         }
 
-        s25fl.spi_write_fnc(txData, 3);         // Escribimos los 3 bytes de la direccion
-    } 
-    else if (addrsize == 16) // Se envia el comando de escritura de pagina seguido de la direccion de 16 bits
+        current = next;
+        readlen = nextlen;
+    }
+
+    S25FL_CS(CS_DISABLE);
+
+    return bytesread;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Escritura masiva con doble buffer: mientras la flash programa
+                una pagina, el callback prepara la siguiente en el otro buffer.
+
+    Para que el tiempo por pagina quede dado por la programacion (tPP) y la
+    transferencia SPI, no se usan las demoras fijas de S25FL_writePage: el
+    bit de escritura y el fin de la programacion se detectan leyendo el
+    registro de estado.
+
+    @note       Antes de escribir los datos, asegurarse que los sectores
+                correspondientes han sido borrados.
+
+    @param[in]  address
+                La direccion de 24 bits donde comenzara la escritura.
+    @param[in]  len
+                Cantidad total de bytes a escribir.
+    @param[in]  *bufA, *bufB
+                Buffers del tamaño de una pagina que se usan alternadamente.
+    @param[in]  callback
+                Funcion que completa el buffer con los datos de la direccion
+                indicada. Debe devolver la cantidad de bytes preparados; si
+                devuelve menos de lo pedido se interrumpe la escritura.
+    @param[in]  ctx
+                Contexto que se le pasa al callback.
+
+    @return     La cantidad de bytes cuya programacion se confirmo.
+*/
+/**************************************************************************/
+uint32_t S25FL_writePipelined(uint32_t address, uint32_t len, uint8_t *bufA, uint8_t *bufB,
+                              s25flChunkCallback_t callback, void *ctx)
+{
+    uint8_t *buffers[2];
+    uint32_t current;
+    uint32_t pagelen, nextlen, prepared, nextprepared;
+    uint32_t byteswritten = 0;
+
+    if (bufA == NULL || bufB == NULL || callback == NULL || address >= TOTAL_SIZE)
     {
-        reg = S25FL_CMD_PAGEPROG;
-        s25fl.spi_writeByte_fnc(reg);
-        
-        txData[0] = (address >> 8) & 0xFF;      // address upper 8
-        txData[1] = (address) & 0xFF;           // address lower 8
+        return 0;
+    }
 
-        s25fl.spi_write_fnc(txData, 2);         // Escribimos los 2 bytes de la direccion
-    } 
-    else 
+    // En caso de sobrepasar la capacidad maxima de la memoria, se trunca.
+    // Se compara contra lo que resta para que address+len no desborde.
+    if (len > TOTAL_SIZE - address)
+    {
+        len = TOTAL_SIZE - address;
+    }
+
+    if (len == 0)   return 0;
+
+    buffers[0] = bufA;
+    buffers[1] = bufB;
+
+    // Se prepara la primera pagina
+    current = 0;
+    pagelen = PAGE_SIZE - (address % PAGE_SIZE);
+    if (pagelen > len)  pagelen = len;
+    prepared = callback(ctx, address, buffers[current], pagelen);
+
+    while (prepared)
+    {
+        if (prepared > pagelen) prepared = pagelen;
+
+        // Se lanza la programacion de la pagina sin esperar a que termine
+        if (!S25FL_pageProgramBegin(address, prepared, true))   break;
+        S25FL_SPI_WRITE(buffers[current], prepared);
+        S25FL_pageProgramEnd(true);
+
+        address += prepared;
+        len -= prepared;
+
+        // Mientras se programa la pagina se prepara la siguiente
+        nextlen = 0;
+        nextprepared = 0;
+        if (prepared == pagelen && len)
+        {
+            current ^= 1;
+            nextlen = (len < PAGE_SIZE) ? len : PAGE_SIZE;
+            nextprepared = callback(ctx, address, buffers[current], nextlen);
+        }
+
+        // Solo se cuentan los bytes de las paginas que terminaron de programarse
+        if (!S25FL_waitForReadyPolled())    break;
+        byteswritten += prepared;
+
+        pagelen = nextlen;
+        prepared = nextprepared;
+    }
+
+    return byteswritten;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Actualiza una region de la flash escribiendo solo lo necesario.
+
+    Por cada sector afectado se comparan los datos nuevos con el contenido
+    actual:
+    - Las paginas que ya tienen los datos nuevos no se escriben.
+    - Si solo hacen falta transiciones de bits 1 a 0, las paginas que
+      cambian se programan sin borrar el sector.
+    - Si hace falta alguna transicion de 0 a 1 se borra el sector y se
+      reescribe completo, preservando los datos fuera de la region; las
+      paginas que quedan en blanco no se programan.
+
+    @param[in]  address
+                La direccion de 24 bits donde comienza la region.
+    @param[in]  *buffer
+                Puntero a los datos nuevos.
+    @param[in]  len
+                Longitud de la region.
+    @param[in]  *sectorBuf
+                Buffer auxiliar de S25FL_SECTORSIZE bytes.
+
+    @return     La cantidad de bytes de la region que quedaron actualizados.
+*/
+/**************************************************************************/
+uint32_t S25FL_updateRange(uint32_t address, uint8_t *buffer, uint32_t len, uint8_t *sectorBuf)
+{
+    uint32_t sectorAddr, offset, spanlen, i, pageoff, pagelen;
+    uint32_t bytesupdated = 0;
+    bool needErase, pageDiffers, pageBlank;
+
+    if (buffer == NULL || sectorBuf == NULL || address >= TOTAL_SIZE)
     {
         return 0;
     }
 
-    // Se envian los datos
-    s25fl.spi_write_fnc(buffer, len); 
+    // En caso de sobrepasar la capacidad maxima de la memoria, se trunca.
+    // Se compara contra lo que resta para que address+len no desborde.
+    if (len > TOTAL_SIZE - address)
+    {
+        len = TOTAL_SIZE - address;
+    }
 
-    // La escritura ocurre luego de que CS se ponga en alto
-    s25fl.chip_select_ctrl(CS_DISABLE);
+    while (len)
+    {
+        sectorAddr = address - (address % S25FL_SECTORSIZE);
+        offset = address - sectorAddr;
+        spanlen = S25FL_SECTORSIZE - offset;
+        if (spanlen > len)  spanlen = len;
 
-    if (! fastquit) {
-        // Se espera hasta que el dispositivo este listo
-        s25fl.delay_fnc(5);
+        // Se lee el contenido actual de la parte del sector a actualizar
+        if (S25FL_readBuffer(address, &sectorBuf[offset], spanlen) != spanlen)  return bytesupdated;
+
+        // Se chequea si algun bit debe pasar de 0 a 1
+        needErase = false;
+        for (i = 0; i < spanlen; i++)
+        {
+            if ((sectorBuf[offset + i] & buffer[i]) != buffer[i])
+            {
+                needErase = true;
+                break;
+            }
+        }
+
+        if (!needErase)
+        {
+            // Se programan solo las paginas que cambian
+            for (pageoff = offset; pageoff < offset + spanlen; pageoff += pagelen)
+            {
+                pagelen = PAGE_SIZE - (pageoff % PAGE_SIZE);
+                if (pageoff + pagelen > offset + spanlen)   pagelen = offset + spanlen - pageoff;
+
+                pageDiffers = false;
+                for (i = 0; i < pagelen; i++)
+                {
+                    if (sectorBuf[pageoff + i] != buffer[pageoff - offset + i])
+                    {
+                        pageDiffers = true;
+                        break;
+                    }
+                }
+
+                if (pageDiffers &&
+                    S25FL_writePage(sectorAddr + pageoff, &buffer[pageoff - offset], pagelen, false) != pagelen)
+                {
+                    return bytesupdated;
+                }
+            }
+        }
+        else
+        {
+            // Se leen los datos del sector que estan fuera de la region para preservarlos
+            if (offset && S25FL_readBuffer(sectorAddr, sectorBuf, offset) != offset)    return bytesupdated;
+            if (offset + spanlen < S25FL_SECTORSIZE)
+            {
+                i = S25FL_SECTORSIZE - (offset + spanlen);
+                if (S25FL_readBuffer(sectorAddr + offset + spanlen, &sectorBuf[offset + spanlen], i) != i)
+                {
+                    return bytesupdated;
+                }
+            }
+
+            memcpy(&sectorBuf[offset], buffer, spanlen);
+
+            if (!S25FL_eraseSector(sectorAddr / S25FL_SECTORSIZE))  return bytesupdated;
+
+            // Se reescribe el sector salteando las paginas en blanco
+            for (pageoff = 0; pageoff < S25FL_SECTORSIZE; pageoff += PAGE_SIZE)
+            {
+                pageBlank = true;
+                for (i = 0; i < PAGE_SIZE; i++)
+                {
+                    if (sectorBuf[pageoff + i] != 0xFF)
+                    {
+                        pageBlank = false;
+                        break;
+                    }
+                }
+
+                if (!pageBlank &&
+                    S25FL_writePage(sectorAddr + pageoff, &sectorBuf[pageoff], PAGE_SIZE, false) != PAGE_SIZE)
+                {
+                    return bytesupdated;
+                }
+            }
+        }
+
+        bytesupdated += spanlen;
+        address += spanlen;
+        buffer += spanlen;
+        len -= spanlen;
     }
 
-    return(len);
+    return bytesupdated;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Envia el comando para salir del modo de bajo consumo, sin
+                esperar tRES. La espera se hace en el primer acceso, solo si
+                no paso el tiempo suficiente.
+*/
+/**************************************************************************/
+static void S25FL_releasePowerDown(void)
+{
+    S25FL_CS(CS_ENABLE);
+    S25FL_SPI_WRITEBYTE(S25FL_CMD_RPWRDDEVID);
+    S25FL_CS(CS_DISABLE);
+
+    wakeTick = S25FL_TICK();
+    powerStats.residency += wakeTick - powerDownTick;
+    powerStats.wakes++;
+    poweredDown = false;
+    waking = true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Habilita CS para enviar un comando, despertando antes a la
+                memoria si estaba en modo de bajo consumo.
+*/
+/**************************************************************************/
+static void S25FL_select(void)
+{
+    if (poweredDown)
+    {
+        S25FL_releasePowerDown();
+    }
+
+    if (waking)
+    {
+        waking = false;
+
+        // Con resolucion de 1 tick solo se asegura tRES si pasaron mas de S25FL_WAKE_DELAY ticks
+        if (!S25FL_HAS_TICK() || (S25FL_TICK() - wakeTick) <= S25FL_WAKE_DELAY)
+        {
+            S25FL_DELAY(S25FL_WAKE_DELAY);
+            powerStats.wakeStalls++;
+            powerStats.wakeWaitTime += S25FL_WAKE_DELAY;
+        }
+    }
+
+    lastActivity = S25FL_TICK();
+    S25FL_CS(CS_ENABLE);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Pone a la memoria en modo de bajo consumo (deep power-down).
+                El proximo acceso la despierta automaticamente.
+
+    @return     True si se entro en bajo consumo, false si la memoria esta
+                ocupada con una escritura o borrado.
+*/
+/**************************************************************************/
+bool S25FL_powerDown(void)
+{
+    if (poweredDown)    return true;
+
+    if (S25FL_readStatus() & SPIFLASH_STAT_BUSY)    return false;
+
+    S25FL_CS(CS_ENABLE);
+    S25FL_SPI_WRITEBYTE(S25FL_CMD_POWERDOWN);
+    S25FL_CS(CS_DISABLE);
+
+    powerDownTick = S25FL_TICK();
+    powerStats.powerDowns++;
+    poweredDown = true;
+
+    return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Registra la base de tiempo opcional para el manejo de energia.
+                Sin ella no hay apagado automatico y el despertar siempre
+                espera tRES.
+
+    @note       Se puede llamar antes o despues de S25FL_InitDriver. Con
+                S25FL_STATIC_PORT se ignora y se usa S25FL_PORT_TICK.
+
+    @param[in]  tick
+                Funcion que devuelve el tiempo actual en ms, o NULL para
+                no usar base de tiempo.
+*/
+/**************************************************************************/
+void S25FL_setTickFnc(tickFnc_t tick)
+{
+#if defined(S25FL_STATIC_PORT)
+    (void)tick;
+#else
+    tickFnc = tick;
+
+    // Los tiempos guardados corresponden a la base anterior
+    lastActivity = S25FL_TICK();
+    powerDownTick = lastActivity;
+    wakeTick = lastActivity;
+#endif
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Configura el tiempo de inactividad luego del cual
+                S25FL_powerTask pone a la memoria en bajo consumo.
+
+    @param[in]  timeout
+                Tiempo en ticks de la base de tiempo registrada con
+                S25FL_setTickFnc. 0 deshabilita el apagado
+                automatico.
+*/
+/**************************************************************************/
+void S25FL_setIdleTimeout(uint32_t timeout)
+{
+    idleTimeout = timeout;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Tarea de manejo de energia. Debe llamarse periodicamente
+                desde el mismo contexto que el resto de las funciones del
+                driver (por ejemplo, el lazo principal), nunca desde una
+                interrupcion u otra tarea que pueda interrumpir un comando en
+                curso. Requiere una base de tiempo (S25FL_setTickFnc).
+*/
+/**************************************************************************/
+void S25FL_powerTask(void)
+{
+    if (poweredDown || idleTimeout == 0 || !S25FL_HAS_TICK())   return;
+
+    if ((S25FL_TICK() - lastActivity) >= idleTimeout)
+    {
+        S25FL_powerDown();
+    }
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Indica que pronto habra un acceso a la memoria. Si esta en
+                bajo consumo se la despierta ahora, de modo que tRES transcurra
+                mientras el programa hace otra cosa.
+*/
+/**************************************************************************/
+void S25FL_prefetchWake(void)
+{
+    if (!poweredDown)   return;
+
+    S25FL_releasePowerDown();
+    powerStats.prefetchWakes++;
+    lastActivity = wakeTick;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Devuelve las estadisticas del manejo de energia.
+
+    @param[out] *stats
+                Estadisticas. residency incluye el tiempo en bajo consumo
+                en curso.
+*/
+/**************************************************************************/
+void S25FL_getPowerStats(s25fl_power_stats_t *stats)
+{
+    if (stats == NULL)  return;
+
+    *stats = powerStats;
+    if (poweredDown)
+    {
+        stats->residency += S25FL_TICK() - powerDownTick;
+    }
 }
 
 /**************************************************************************/
@@ -474,7 +1358,7 @@ uint32_t S25FL_writePage (uint32_t address, uint8_t *buffer, uint32_t len, bool
 /**************************************************************************/
 int32_t S25FL_pageSize()
 {
-    return pagesize;
+    return PAGE_SIZE;
 }
 
 /**************************************************************************/
@@ -484,7 +1368,7 @@ int32_t S25FL_pageSize()
 /**************************************************************************/
 int8_t S25FL_addressSize()
 {
-    return addrsize;
+    return ADDR_SIZE;
 }
 
 /**************************************************************************/
@@ -494,5 +1378,5 @@ int8_t S25FL_addressSize()
 /**************************************************************************/
 int32_t S25FL_numPages()
 {
-    return pages;
+    return NUM_PAGES;
 }
\ No newline at end of file
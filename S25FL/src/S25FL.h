@@ -69,6 +69,29 @@
 #define S25FL_ID_LEN                    3
 
 #define READY_TIMEOUT                   2000
+#define READY_POLLS                     256    // Lecturas de estado sin demoras antes de esperar de a 1 ms
+#define S25FL_WAKE_DELAY                1      // tRES redondeado a la resolucion de delay_fnc y del tick (ms)
+
+/*
+ * Configuracion en tiempo de compilacion (opcional)
+ *
+ * S25FL_CONFIG_FILE        Header a incluir en S25FL.c con la configuracion,
+ *                          p. ej. -DS25FL_CONFIG_FILE='"S25FL_board_config.h"'.
+ *                          S25FL_config_CIAA.h es un ejemplo para la CIAA.
+ * S25FL_STATIC_PORT        Las funciones del port se llaman directamente en lugar
+ *                          de hacerlo a traves de los punteros de s25fl_t. Se deben
+ *                          definir S25FL_PORT_CHIP_SELECT, S25FL_PORT_SPI_READ,
+ *                          S25FL_PORT_SPI_WRITE, S25FL_PORT_SPI_WRITEBYTE y
+ *                          S25FL_PORT_DELAY, y opcionalmente
+ *                          S25FL_PORT_SPI_READ_ASYNC, S25FL_PORT_SPI_WAIT y
+ *                          S25FL_PORT_TICK. Si el header de configuracion las
+ *                          define como static inline, el compilador las expande
+ *                          en linea.
+ * S25FL_STATIC_GEOMETRY    La geometria de la memoria es constante. Se pueden
+ *                          redefinir S25FL_STATIC_PAGESIZE (potencia de 2),
+ *                          S25FL_STATIC_ADDRSIZE (16 o 24) y S25FL_STATIC_PAGES;
+ *                          por defecto corresponden a la S25FL064L.
+ */
 
 typedef enum
 {
@@ -89,6 +112,10 @@ typedef void (*spiWrite_t)(uint8_t*, uint32_t);
 typedef void (*spiWriteByte_t)(uint8_t);
 typedef uint8_t (*spiReadRegister_t)(uint8_t);
 typedef void (*delayFnc_t)(uint32_t);
+typedef bool (*spiWait_t)(void);
+typedef uint32_t (*tickFnc_t)(void);
+typedef uint32_t (*s25flProducer_t)(void*, uint8_t**, uint32_t);
+typedef uint32_t (*s25flChunkCallback_t)(void*, uint32_t, uint8_t*, uint32_t);
 
 typedef struct
 {
@@ -101,15 +128,48 @@ typedef struct
     s25fl_size_t memory_size;
 } s25fl_t;
 
+// Buffer circular: esta vacio si head == tail, por lo que guarda hasta size - 1 bytes
+typedef struct
+{
+    uint8_t *buffer;
+    uint32_t size;
+    uint32_t head;      // Indice del proximo byte que cargara el productor (p. ej. el DMA)
+    uint32_t tail;      // Indice del proximo byte a escribir en la flash
+} s25fl_ring_t;
+
+typedef struct
+{
+    uint32_t powerDowns;    // Veces que se entro en bajo consumo
+    uint32_t wakes;         // Veces que se desperto a la memoria
+    uint32_t prefetchWakes; // Despertares anticipados por S25FL_prefetchWake
+    uint32_t wakeStalls;    // Accesos que tuvieron que esperar tRES
+    uint32_t wakeWaitTime;  // Tiempo total esperado por tRES (ms)
+    uint32_t residency;     // Tiempo total en bajo consumo (ms)
+} s25fl_power_stats_t;
+
 
 bool S25FL_InitDriver(s25fl_t config);
 uint8_t S25FL_readStatus();
 uint32_t S25FL_readDevID();
+void S25FL_setAsyncRead(spiRead_t readAsync, spiWait_t wait);
 void S25FL_writeEnable (bool enable);
 uint32_t S25FL_readBuffer (uint32_t address, uint8_t *buffer, uint32_t len);
 bool S25FL_eraseSector (uint32_t sectorNumber);
 uint32_t S25FL_writeBuffer(uint32_t address, uint8_t *buffer, uint32_t len);
 uint32_t S25FL_writePage (uint32_t address, uint8_t *buffer, uint32_t len, bool fastquit);
+uint32_t S25FL_writeStream(uint32_t address, s25flProducer_t producer, void *ctx, uint32_t len);
+uint32_t S25FL_writeRing(uint32_t address, s25fl_ring_t *ring, uint32_t len);
+uint32_t S25FL_readPipelined(uint32_t address, uint32_t len, uint8_t *bufA, uint8_t *bufB,
+                             uint32_t chunkSize, s25flChunkCallback_t callback, void *ctx);
+uint32_t S25FL_writePipelined(uint32_t address, uint32_t len, uint8_t *bufA, uint8_t *bufB,
+                              s25flChunkCallback_t callback, void *ctx);
+uint32_t S25FL_updateRange(uint32_t address, uint8_t *buffer, uint32_t len, uint8_t *sectorBuf);
+bool S25FL_powerDown(void);
+void S25FL_setTickFnc(tickFnc_t tick);
+void S25FL_setIdleTimeout(uint32_t timeout);
+void S25FL_powerTask(void);
+void S25FL_prefetchWake(void);
+void S25FL_getPowerStats(s25fl_power_stats_t *stats);
 int32_t S25FL_pageSize();
 int8_t S25FL_addressSize();
 int32_t S25FL_numPages();
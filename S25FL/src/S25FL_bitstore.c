@@ -0,0 +1,379 @@
+/*
+ *  S25FL_bitstore.c
+ *
+ *  Contadores y mapas de bits que se actualizan sin borrar la flash.
+ *  En una NOR flash la programacion solo puede pasar bits de 1 a 0, por lo
+ *  que cada actualizacion cuesta una programacion de pagina de un byte y el
+ *  borrado de sector solo es necesario cuando la region se satura.
+ * 
+ */
+
+#include "S25FL_bitstore.h"
+#include <stddef.h>
+
+// Buffer para recorrer los mapas de bits de a una pagina
+static uint8_t scanBuffer[S25FL_PAGESIZE];
+
+static uint32_t S25FL_counterReadBase(uint32_t sector);
+static bool S25FL_counterWriteBase(uint32_t sector, uint32_t base);
+static uint32_t S25FL_counterScan(uint32_t sector);
+static bool S25FL_clearBit(uint32_t address, uint32_t bit);
+
+/**************************************************************************/
+/*! 
+    @brief      Lee el valor base guardado en la cabecera de un sector.
+
+    @details    La cabecera tiene el valor base seguido de su complemento,
+                ambos de 32 bits. Si se corto la alimentacion mientras se
+                programaba la cabecera o se borraba el sector, quedan bits
+                en 1 y el complemento no coincide.
+
+    @return     El valor base, o S25FL_COUNTER_BLANK si el sector no tiene
+                una cabecera valida.
+*/
+/**************************************************************************/
+static uint32_t S25FL_counterReadBase(uint32_t sector)
+{
+    uint8_t header[S25FL_COUNTER_HEADER_SIZE];
+    uint32_t base, check;
+
+    if (S25FL_readBuffer(sector * S25FL_SECTORSIZE, header, sizeof(header)) != sizeof(header))
+    {
+        return S25FL_COUNTER_BLANK;
+    }
+
+    base = ((uint32_t)header[0]) + (((uint32_t)header[1])<<8) +
+           (((uint32_t)header[2])<<16) + (((uint32_t)header[3])<<24);
+    check = ((uint32_t)header[4]) + (((uint32_t)header[5])<<8) +
+            (((uint32_t)header[6])<<16) + (((uint32_t)header[7])<<24);
+
+    if (check != ~base) return S25FL_COUNTER_BLANK;
+
+    return base;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Borra un sector y escribe el valor base y su complemento en
+                su cabecera.
+*/
+/**************************************************************************/
+static bool S25FL_counterWriteBase(uint32_t sector, uint32_t base)
+{
+    uint8_t header[S25FL_COUNTER_HEADER_SIZE];
+
+    header[0] = base & 0xFF;
+    header[1] = (base >> 8) & 0xFF;
+    header[2] = (base >> 16) & 0xFF;
+    header[3] = (base >> 24) & 0xFF;
+    header[4] = ~header[0];
+    header[5] = ~header[1];
+    header[6] = ~header[2];
+    header[7] = ~header[3];
+
+    if (!S25FL_eraseSector(sector)) return false;
+
+    return S25FL_writePage(sector * S25FL_SECTORSIZE, header, sizeof(header), false) == sizeof(header);
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Cuenta los bits borrados en un sector del contador.
+
+    @details    Los bits se borran en orden, desde el bit mas significativo
+                del primer byte, por lo que los bytes en 0x00 estan todos
+                antes que el resto. El primer byte distinto de 0x00 se busca
+                con una busqueda binaria, leyendo un byte por paso.
+*/
+/**************************************************************************/
+static uint32_t S25FL_counterScan(uint32_t sector)
+{
+    uint32_t data = sector * S25FL_SECTORSIZE + S25FL_COUNTER_HEADER_SIZE;
+    uint32_t low = 0, high = S25FL_SECTORSIZE - S25FL_COUNTER_HEADER_SIZE;
+    uint32_t mid, used;
+    uint8_t value;
+
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        S25FL_readBuffer(data + mid, &value, 1);
+        if (value == 0x00)  low = mid + 1;
+        else                high = mid;
+    }
+
+    used = low * 8;
+    if (low < S25FL_SECTORSIZE - S25FL_COUNTER_HEADER_SIZE)
+    {
+        // Se cuentan los bits borrados del byte parcialmente usado
+        S25FL_readBuffer(data + low, &value, 1);
+        while (!(value & 0x80))
+        {
+            value <<= 1;
+            used++;
+        }
+    }
+
+    return used;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Programa en 0 un bit de la flash sin modificar el resto.
+
+    @param[in]  address
+                Direccion de inicio de la region de bits.
+    @param[in]  bit
+                Numero de bit dentro de la region; el bit 0 es el mas
+                significativo del primer byte.
+*/
+/**************************************************************************/
+static bool S25FL_clearBit(uint32_t address, uint32_t bit)
+{
+    uint8_t value = (uint8_t)~(0x80 >> (bit % 8));
+
+    return S25FL_writePage(address + bit / 8, &value, 1, false) == 1;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Inicializa un contador monotonico sobre dos sectores,
+                recuperando su valor si ya existia.
+
+    @details    Cada sector tiene en su cabecera el valor base y luego un bit
+                por incremento. El sector activo es el de mayor base valida;
+                las cabeceras incompletas o danadas se descartan. Si ningun
+                sector tiene una cabecera valida, el contador se inicia en
+                cero.
+
+    @param[out] *counter
+                Contador a inicializar.
+    @param[in]  sectorA, sectorB
+                Sectores de la flash reservados para el contador.
+
+    @return     True si se inicializo correctamente.
+*/
+/**************************************************************************/
+bool S25FL_counterInit(s25fl_counter_t *counter, uint32_t sectorA, uint32_t sectorB)
+{
+    uint32_t baseA, baseB;
+
+    if (counter == NULL || sectorA == sectorB) return false;
+
+    counter->sector[0] = sectorA;
+    counter->sector[1] = sectorB;
+
+    baseA = S25FL_counterReadBase(sectorA);
+    baseB = S25FL_counterReadBase(sectorB);
+
+    if (baseA == S25FL_COUNTER_BLANK && baseB == S25FL_COUNTER_BLANK)
+    {
+        // Contador nuevo
+        if (!S25FL_counterWriteBase(sectorA, 0))   return false;
+        counter->active = 0;
+        counter->base = 0;
+        counter->used = 0;
+        return true;
+    }
+
+    if (baseB == S25FL_COUNTER_BLANK || (baseA != S25FL_COUNTER_BLANK && baseA >= baseB))
+    {
+        counter->active = 0;
+        counter->base = baseA;
+    }
+    else
+    {
+        counter->active = 1;
+        counter->base = baseB;
+    }
+
+    counter->used = S25FL_counterScan(counter->sector[counter->active]);
+
+    return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Incrementa el contador en uno.
+
+    @details    Normalmente se programa un solo byte. Cuando el sector activo
+                se satura, se borra el otro sector, se guarda en el el valor
+                actual como base y recien entonces se borra el anterior.
+
+    @return     True si se incremento correctamente.
+*/
+/**************************************************************************/
+bool S25FL_counterIncrement(s25fl_counter_t *counter)
+{
+    uint8_t next;
+
+    if (counter == NULL)    return false;
+
+    if (counter->used >= S25FL_COUNTER_BITS)
+    {
+        next = counter->active ^ 1;
+        if (counter->base + counter->used >= S25FL_COUNTER_BLANK)   return false;
+        if (!S25FL_counterWriteBase(counter->sector[next], counter->base + counter->used))   return false;
+        S25FL_eraseSector(counter->sector[counter->active]);
+
+        counter->active = next;
+        counter->base += counter->used;
+        counter->used = 0;
+    }
+
+    if (!S25FL_clearBit(counter->sector[counter->active] * S25FL_SECTORSIZE + S25FL_COUNTER_HEADER_SIZE,
+                        counter->used))
+    {
+        return false;
+    }
+
+    counter->used++;
+
+    return true;
+}
+
+/**************************************************************************/
+/*! 
+    @return     El valor actual del contador.
+*/
+/**************************************************************************/
+uint32_t S25FL_counterValue(s25fl_counter_t *counter)
+{
+    if (counter == NULL)    return 0;
+
+    return counter->base + counter->used;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Inicializa un mapa de bits que comienza en un sector. Un bit
+                en 1 indica un elemento libre y en 0 uno ocupado.
+
+    @note       No se lee ni se modifica la flash, para poder recuperar un
+                mapa existente luego de un reinicio. La primera vez que se
+                usa la region como mapa se debe llamar a S25FL_bitmapReset;
+                si no, los datos que tenga se ven como bits ocupados.
+
+    @param[out] *bitmap
+                Mapa de bits a inicializar.
+    @param[in]  firstSector
+                Primer sector reservado para el mapa.
+    @param[in]  bits
+                Cantidad de bits del mapa.
+
+    @return     True si el mapa entra en la memoria.
+*/
+/**************************************************************************/
+bool S25FL_bitmapInit(s25fl_bitmap_t *bitmap, uint32_t firstSector, uint32_t bits)
+{
+    uint32_t totalsize = (uint32_t)S25FL_pageSize() * (uint32_t)S25FL_numPages();
+
+    if (bitmap == NULL || bits == 0)    return false;
+
+    bitmap->address = firstSector * S25FL_SECTORSIZE;
+    bitmap->bits = bits;
+
+    if (bitmap->address + (bits + 7) / 8 > totalsize)   return false;
+
+    return true;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Marca un bit como ocupado (lo programa en 0).
+*/
+/**************************************************************************/
+bool S25FL_bitmapClear(s25fl_bitmap_t *bitmap, uint32_t bit)
+{
+    if (bitmap == NULL || bit >= bitmap->bits)  return false;
+
+    return S25FL_clearBit(bitmap->address, bit);
+}
+
+/**************************************************************************/
+/*! 
+    @return     True si el bit esta en 1 (libre).
+*/
+/**************************************************************************/
+bool S25FL_bitmapTest(s25fl_bitmap_t *bitmap, uint32_t bit)
+{
+    uint8_t value;
+
+    if (bitmap == NULL || bit >= bitmap->bits)  return false;
+
+    if (S25FL_readBuffer(bitmap->address + bit / 8, &value, 1) != 1)    return false;
+
+    return (value & (0x80 >> (bit % 8))) != 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Busca el primer bit en 1 (libre) a partir de un bit dado.
+
+    @details    El mapa se lee de a una pagina y los bytes en 0x00 se
+                descartan sin revisar sus bits.
+
+    @return     El numero de bit encontrado, o -1 si el mapa esta saturado
+                desde from en adelante.
+*/
+/**************************************************************************/
+int32_t S25FL_bitmapFindSet(s25fl_bitmap_t *bitmap, uint32_t from)
+{
+    uint32_t byteIndex, bytes, chunk, i, bit;
+    uint8_t value;
+
+    if (bitmap == NULL || from >= bitmap->bits) return -1;
+
+    bytes = (bitmap->bits + 7) / 8;
+    byteIndex = from / 8;
+
+    while (byteIndex < bytes)
+    {
+        chunk = bytes - byteIndex;
+        if (chunk > sizeof(scanBuffer)) chunk = sizeof(scanBuffer);
+
+        if (S25FL_readBuffer(bitmap->address + byteIndex, scanBuffer, chunk) != chunk)  return -1;
+
+        for (i = 0; i < chunk; i++)
+        {
+            value = scanBuffer[i];
+            if (value == 0x00)  continue;
+
+            for (bit = 0; bit < 8; bit++)
+            {
+                if ((value & (0x80 >> bit)) &&
+                    (byteIndex + i) * 8 + bit >= from &&
+                    (byteIndex + i) * 8 + bit < bitmap->bits)
+                {
+                    return (int32_t)((byteIndex + i) * 8 + bit);
+                }
+            }
+        }
+
+        byteIndex += chunk;
+    }
+
+    return -1;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Libera todos los bits del mapa borrando los sectores que
+                ocupa. Es la unica operacion del mapa que requiere borrado.
+*/
+/**************************************************************************/
+bool S25FL_bitmapReset(s25fl_bitmap_t *bitmap)
+{
+    uint32_t sector, lastSector;
+
+    if (bitmap == NULL) return false;
+
+    sector = bitmap->address / S25FL_SECTORSIZE;
+    lastSector = (bitmap->address + (bitmap->bits + 7) / 8 - 1) / S25FL_SECTORSIZE;
+
+    for (; sector <= lastSector; sector++)
+    {
+        if (!S25FL_eraseSector(sector)) return false;
+    }
+
+    return true;
+}
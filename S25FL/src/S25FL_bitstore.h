@@ -0,0 +1,42 @@
+/*
+ *  S25FL_bitstore.h
+ *
+ *  Contadores y mapas de bits que se actualizan sin borrar la flash,
+ *  programando unicamente transiciones de bits de 1 a 0.
+ * 
+ */
+
+#ifndef _S25FL_BITSTORE_H_
+#define _S25FL_BITSTORE_H_
+
+#include "S25FL.h"
+
+#define S25FL_COUNTER_HEADER_SIZE       8      // Valor base del sector y su complemento, en bytes
+#define S25FL_COUNTER_BITS              ((S25FL_SECTORSIZE - S25FL_COUNTER_HEADER_SIZE) * 8)
+#define S25FL_COUNTER_BLANK             0xFFFFFFFF
+
+typedef struct
+{
+    uint32_t sector[2];     // Sectores que se alternan al saturarse el activo
+    uint8_t active;         // Indice del sector activo
+    uint32_t base;          // Valor del contador al comenzar el sector activo
+    uint32_t used;          // Bits ya borrados en el sector activo
+} s25fl_counter_t;
+
+typedef struct
+{
+    uint32_t address;       // Direccion de inicio, alineada a un sector
+    uint32_t bits;          // Cantidad de bits del mapa
+} s25fl_bitmap_t;
+
+bool S25FL_counterInit(s25fl_counter_t *counter, uint32_t sectorA, uint32_t sectorB);
+bool S25FL_counterIncrement(s25fl_counter_t *counter);
+uint32_t S25FL_counterValue(s25fl_counter_t *counter);
+
+bool S25FL_bitmapInit(s25fl_bitmap_t *bitmap, uint32_t firstSector, uint32_t bits);
+bool S25FL_bitmapClear(s25fl_bitmap_t *bitmap, uint32_t bit);
+bool S25FL_bitmapTest(s25fl_bitmap_t *bitmap, uint32_t bit);
+int32_t S25FL_bitmapFindSet(s25fl_bitmap_t *bitmap, uint32_t from);
+bool S25FL_bitmapReset(s25fl_bitmap_t *bitmap);
+
+#endif // _S25FL_BITSTORE_H_
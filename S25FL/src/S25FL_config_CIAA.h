@@ -0,0 +1,27 @@
+/*
+ *  S25FL_config_CIAA.h
+ *
+ *  Ejemplo de configuracion en tiempo de compilacion del driver (ver S25FL.h):
+ *  fija el port de la CIAA y la geometria de la S25FL064L. Se usa compilando
+ *  S25FL.c con -DS25FL_CONFIG_FILE='"S25FL_config_CIAA.h"'.
+ * 
+ */
+
+#ifndef _S25FL_CONFIG_CIAA_H_
+#define _S25FL_CONFIG_CIAA_H_
+
+#include "S25FL_CIAA_port.h"
+
+#define S25FL_STATIC_PORT
+#define S25FL_PORT_CHIP_SELECT(state)       chipSelect_CIAA_port(state)
+#define S25FL_PORT_SPI_READ(buf, len)       spiRead_CIAA_port(buf, len)
+#define S25FL_PORT_SPI_WRITE(buf, len)      spiWrite_CIAA_port(buf, len)
+#define S25FL_PORT_SPI_WRITEBYTE(data)      spiWriteByte_CIAA_port(data)
+#define S25FL_PORT_DELAY(ms)                delay_CIAA_port(ms)
+// El port de la CIAA no provee lectura asincronica ni base de tiempo, por lo que
+// no se definen S25FL_PORT_SPI_READ_ASYNC, S25FL_PORT_SPI_WAIT ni S25FL_PORT_TICK
+
+// Geometria por defecto: S25FL064L, paginas de 256 bytes y direcciones de 24 bits
+#define S25FL_STATIC_GEOMETRY
+
+#endif // _S25FL_CONFIG_CIAA_H_
@@ -0,0 +1,144 @@
+/*
+ *  S25FL_lfs.c
+ *
+ *  Adaptador de dispositivo de bloques de littlefs para la memoria S25FL.
+ *  Cada bloque de littlefs corresponde a un sector de 4 KB de la flash.
+ * 
+ */
+
+#include "S25FL_lfs.h"
+#include <stddef.h>
+#include <string.h>
+
+// Buffers de cache y lookahead, del tamaño de una pagina de la flash
+static uint32_t readBuffer[S25FL_PAGESIZE / sizeof(uint32_t)];
+static uint32_t progBuffer[S25FL_PAGESIZE / sizeof(uint32_t)];
+static uint32_t lookaheadBuffer[S25FL_PAGESIZE / sizeof(uint32_t)];
+
+/**************************************************************************/
+/*! 
+    @brief      Lee una region de un bloque.
+
+    @return     0 si se leyo correctamente, LFS_ERR_IO en caso contrario.
+*/
+/**************************************************************************/
+int S25FL_lfs_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size)
+{
+    uint32_t address = block * c->block_size + off;
+
+    if (S25FL_readBuffer(address, (uint8_t *)buffer, size) != size)
+    {
+        return LFS_ERR_IO;
+    }
+
+    return 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Programa una region de un bloque previamente borrado.
+                Como prog_size es el tamaño de pagina, cada llamada escribe
+                paginas completas.
+
+    @return     0 si se escribio correctamente, LFS_ERR_IO en caso contrario.
+*/
+/**************************************************************************/
+int S25FL_lfs_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size)
+{
+    uint32_t address = block * c->block_size + off;
+
+    if (S25FL_writeBuffer(address, (uint8_t *)buffer, size) != size)
+    {
+        return LFS_ERR_IO;
+    }
+
+    return 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Borra un bloque (un sector de la flash).
+
+    @return     0 si se borro correctamente, LFS_ERR_IO en caso contrario.
+*/
+/**************************************************************************/
+int S25FL_lfs_erase(const struct lfs_config *c, lfs_block_t block)
+{
+    (void)c;
+
+    if (!S25FL_eraseSector(block))
+    {
+        return LFS_ERR_IO;
+    }
+
+    return 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Las escrituras del driver son sincronicas, por lo que no hay
+                datos pendientes.
+*/
+/**************************************************************************/
+int S25FL_lfs_sync(const struct lfs_config *c)
+{
+    (void)c;
+
+    return 0;
+}
+
+/**************************************************************************/
+/*! 
+    @brief      Completa la configuracion de littlefs a partir de la geometria
+                de la flash.
+
+    @details    Los tamaños de lectura, programacion y cache se igualan al
+                tamaño de pagina, de modo que cada acceso de littlefs se
+                traduce en comandos de pagina completa. El lookahead cubre
+                todos los bloques de la memoria, limitado a una pagina.
+                Se debe llamar luego de S25FL_InitDriver.
+
+    @param[out] *cfg
+                Configuracion a completar. Los campos no relacionados con el
+                dispositivo (name_max, file_max, etc.) quedan en cero para
+                que littlefs use sus valores por defecto.
+
+    @return     True si la geometria es compatible con el adaptador.
+*/
+/**************************************************************************/
+bool S25FL_lfs_config(struct lfs_config *cfg)
+{
+    uint32_t pagesize = (uint32_t)S25FL_pageSize();
+    uint32_t totalsize = pagesize * (uint32_t)S25FL_numPages();
+    uint32_t lookahead;
+
+    if (cfg == NULL || pagesize == 0 || pagesize > S25FL_PAGESIZE)
+    {
+        return false;
+    }
+
+    memset(cfg, 0, sizeof(*cfg));
+
+    cfg->read = S25FL_lfs_read;
+    cfg->prog = S25FL_lfs_prog;
+    cfg->erase = S25FL_lfs_erase;
+    cfg->sync = S25FL_lfs_sync;
+
+    cfg->read_size = pagesize;
+    cfg->prog_size = pagesize;
+    cfg->cache_size = pagesize;
+    cfg->block_size = S25FL_SECTORSIZE;
+    cfg->block_count = totalsize / S25FL_SECTORSIZE;
+    cfg->block_cycles = S25FL_LFS_BLOCK_CYCLES;
+
+    // Un bit de lookahead por bloque, en multiplos de 8 bytes
+    lookahead = ((cfg->block_count / 8) + 7) & ~7u;
+    if (lookahead > pagesize)   lookahead = pagesize;
+    cfg->lookahead_size = lookahead;
+
+    cfg->read_buffer = readBuffer;
+    cfg->prog_buffer = progBuffer;
+    cfg->lookahead_buffer = lookaheadBuffer;
+
+    return true;
+}
@@ -0,0 +1,22 @@
+/*
+ *  S25FL_lfs.h
+ *
+ *  Adaptador de dispositivo de bloques de littlefs para la memoria S25FL.
+ * 
+ */
+
+#ifndef _S25FL_LFS_H_
+#define _S25FL_LFS_H_
+
+#include "lfs.h"
+#include "S25FL.h"
+
+#define S25FL_LFS_BLOCK_CYCLES          500    // Ciclos de borrado antes de mover un bloque de metadatos
+
+int S25FL_lfs_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size);
+int S25FL_lfs_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size);
+int S25FL_lfs_erase(const struct lfs_config *c, lfs_block_t block);
+int S25FL_lfs_sync(const struct lfs_config *c);
+bool S25FL_lfs_config(struct lfs_config *cfg);
+
+#endif // _S25FL_LFS_H_
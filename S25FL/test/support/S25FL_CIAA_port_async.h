@@ -0,0 +1,18 @@
+/*
+ *  S25FL_CIAA_port_async.h
+ *
+ *  Lectura asincronica para S25FL_setAsyncRead. El port de la CIAA no la
+ *  implementa; se declara aca para simularla y para generar su mock en las
+ *  pruebas.
+ * 
+ */
+
+#ifndef _S25FL_CIAA_PORT_ASYNC_H_
+#define _S25FL_CIAA_PORT_ASYNC_H_
+
+#include "S25FL.h"
+
+bool spiReadAsync_CIAA_port(uint8_t* buffer, uint32_t bufferSize);
+bool spiWait_CIAA_port(void);
+
+#endif // _S25FL_CIAA_PORT_ASYNC_H_
@@ -0,0 +1,203 @@
+/*
+ *  S25FL_sim.c
+ *
+ *  Simulacion en el host de una memoria S25FL064L conectada a las funciones
+ *  del port de la CIAA. Implementa los comandos usados por el driver con la
+ *  semantica de una NOR flash: la programacion solo pasa bits de 1 a 0 y el
+ *  borrado de sector los vuelve a 1.
+ * 
+ */
+
+#include "S25FL_sim.h"
+#include <string.h>
+
+static uint8_t memory[S25FL_SIM_SIZE];
+static s25fl_sim_stats_t stats;
+
+static bool selected;
+static bool writeEnabled;
+static bool forcedBusy;         // Simula una operacion interna que no termina
+static bool deepPowerDown;      // Solo se acepta el comando para despertar
+static uint32_t now;            // Tiempo simulado en ms, avanza con delay_CIAA_port
+static uint8_t command;
+static uint32_t cmdBytes;       // Bytes recibidos desde que se habilito CS
+static uint32_t address;
+
+static void S25FL_sim_byteIn(uint8_t data)
+{
+    if (!selected)  return;
+
+    if (cmdBytes == 0)
+    {
+        // En bajo consumo se ignoran todos los comandos salvo el de despertar
+        if (deepPowerDown && data != S25FL_CMD_RPWRDDEVID)  data = 0;
+
+        command = data;
+        address = 0;
+        if (command == S25FL_CMD_WRITEENABLE)   writeEnabled = true;
+        if (command == S25FL_CMD_WRITEDISABLE)  writeEnabled = false;
+    }
+    else if (cmdBytes <= S25FL_MAX_ADDRESS_SIZE)
+    {
+        address = (address << 8) | data;
+    }
+    else if (command == S25FL_CMD_PAGEPROG && writeEnabled)
+    {
+        // Dentro de la pagina la direccion da la vuelta
+        memory[address % S25FL_SIM_SIZE] &= data;
+        address = (address & ~(uint32_t)(S25FL_PAGESIZE - 1)) | ((address + 1) & (S25FL_PAGESIZE - 1));
+    }
+    cmdBytes++;
+}
+
+void chipSelect_CIAA_port(csState_t estado)
+{
+    if (estado == CS_ENABLE)
+    {
+        selected = true;
+        cmdBytes = 0;
+        return;
+    }
+
+    if (selected && cmdBytes == 1)
+    {
+        if (command == S25FL_CMD_POWERDOWN)
+        {
+            deepPowerDown = true;
+            stats.powerDowns++;
+        }
+        else if (command == S25FL_CMD_RPWRDDEVID && deepPowerDown)
+        {
+            deepPowerDown = false;
+            stats.wakes++;
+        }
+    }
+    else if (selected && cmdBytes > S25FL_MAX_ADDRESS_SIZE)
+    {
+        if (command == S25FL_CMD_PAGEPROG && writeEnabled)
+        {
+            stats.pageProgs++;
+            writeEnabled = false;
+        }
+        else if (command == S25FL_CMD_SECTERASE4 && writeEnabled)
+        {
+            memset(&memory[(address % S25FL_SIM_SIZE) & ~(uint32_t)(S25FL_SECTORSIZE - 1)], 0xFF, S25FL_SECTORSIZE);
+            stats.sectorErases++;
+            writeEnabled = false;
+        }
+    }
+    selected = false;
+}
+
+bool spiRead_CIAA_port(uint8_t* buffer, uint32_t bufferSize)
+{
+    uint32_t i;
+
+    for (i = 0; i < bufferSize; i++)
+    {
+        if (command == S25FL_CMD_READSTAT1)
+        {
+            buffer[i] = (writeEnabled ? SPIFLASH_STAT_WRTEN : 0) | (forcedBusy ? SPIFLASH_STAT_BUSY : 0);
+        }
+        else if (command == SPIFLASH_SPI_DATAREAD)
+        {
+            buffer[i] = memory[address % S25FL_SIM_SIZE];
+            address++;
+            stats.bytesRead++;
+        }
+        else
+        {
+            buffer[i] = 0;
+        }
+    }
+
+    return true;
+}
+
+uint8_t spiReadRegister_CIAA_port(uint8_t reg)
+{
+    (void)reg;
+    return 0;
+}
+
+void spiWrite_CIAA_port(uint8_t* buffer, uint32_t bufferSize)
+{
+    uint32_t i;
+
+    for (i = 0; i < bufferSize; i++)
+    {
+        S25FL_sim_byteIn(buffer[i]);
+    }
+}
+
+void spiWriteByte_CIAA_port(uint8_t data)
+{
+    S25FL_sim_byteIn(data);
+}
+
+bool spiReadAsync_CIAA_port(uint8_t* buffer, uint32_t bufferSize)
+{
+    // La simulacion completa la transferencia inmediatamente
+    return spiRead_CIAA_port(buffer, bufferSize);
+}
+
+bool spiWait_CIAA_port(void)
+{
+    return true;
+}
+
+void delay_CIAA_port(uint32_t millisecs)
+{
+    now += millisecs;
+}
+
+void S25FL_sim_reset(void)
+{
+    memset(memory, 0xFF, sizeof(memory));
+    memset(&stats, 0, sizeof(stats));
+    selected = false;
+    writeEnabled = false;
+    forcedBusy = false;
+    deepPowerDown = false;
+    now = 0;
+}
+
+s25fl_t S25FL_sim_driverConfig(void)
+{
+    s25fl_t config;
+
+    config.chip_select_ctrl = chipSelect_CIAA_port;
+    config.spi_write_fnc = spiWrite_CIAA_port;
+    config.spi_writeByte_fnc = spiWriteByte_CIAA_port;
+    config.spi_read_fnc = spiRead_CIAA_port;
+    config.spi_read_register = spiReadRegister_CIAA_port;
+    config.delay_fnc = delay_CIAA_port;
+    config.memory_size = S64MB;
+
+    return config;
+}
+
+uint8_t* S25FL_sim_memory(void)
+{
+    return memory;
+}
+
+s25fl_sim_stats_t S25FL_sim_stats(void)
+{
+    return stats;
+}
+
+void S25FL_sim_setBusy(bool busy)
+{
+    forcedBusy = busy;
+}
+
+uint32_t S25FL_sim_tick(void)
+{
+    return now;
+}
+
+void S25FL_sim_advance(uint32_t millisecs)
+{
+    now += millisecs;
+}
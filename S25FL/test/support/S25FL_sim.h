@@ -0,0 +1,34 @@
+/*
+ *  S25FL_sim.h
+ *
+ *  Simulacion en el host de una memoria S25FL064L conectada a las funciones
+ *  del port de la CIAA, para pruebas de modulos que usan el driver completo.
+ * 
+ */
+
+#ifndef _S25FL_SIM_H_
+#define _S25FL_SIM_H_
+
+#include "S25FL_CIAA_port.h"
+#include "S25FL_CIAA_port_async.h"
+
+#define S25FL_SIM_SIZE                  (S25FL_PAGES * S25FL_PAGESIZE)
+
+typedef struct
+{
+    uint32_t pageProgs;     // Comandos de programacion de pagina ejecutados
+    uint32_t sectorErases;  // Comandos de borrado de sector ejecutados
+    uint32_t bytesRead;     // Bytes de datos leidos
+    uint32_t powerDowns;    // Comandos de bajo consumo ejecutados
+    uint32_t wakes;         // Comandos para despertar ejecutados en bajo consumo
+} s25fl_sim_stats_t;
+
+void S25FL_sim_reset(void);
+s25fl_t S25FL_sim_driverConfig(void);
+uint8_t* S25FL_sim_memory(void);
+s25fl_sim_stats_t S25FL_sim_stats(void);
+void S25FL_sim_setBusy(bool busy);
+uint32_t S25FL_sim_tick(void);
+void S25FL_sim_advance(uint32_t millisecs);
+
+#endif // _S25FL_SIM_H_
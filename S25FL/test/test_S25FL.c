@@ -12,6 +12,8 @@
 #include "unity.h"
 #include "S25FL.h"
 #include "mock_S25FL_CIAA_port.h"
+#include "mock_S25FL_CIAA_port_async.h"
+#include <string.h>
 
 #define ERROR_ESCRITURA         0
 
@@ -21,6 +23,18 @@
  */
 s25fl_t s25flDriverStruct;
 
+/**
+ * @brief Simula el comando para salir del modo de bajo consumo que se envia
+ *        al inicializar el driver.
+ * 
+ */
+static void despertarAlInicializar(void) {
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_RPWRDDEVID);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    delay_CIAA_port_Expect(S25FL_WAKE_DELAY);
+}
+
 void setUp(void) {
     // Se inicializa la estructura con los punteros a las funciones del port
     s25flDriverStruct.chip_select_ctrl = chipSelect_CIAA_port;
@@ -30,18 +44,24 @@ void setUp(void) {
     s25flDriverStruct.spi_read_register = spiReadRegister_CIAA_port;
     s25flDriverStruct.delay_fnc = delay_CIAA_port;
     s25flDriverStruct.memory_size = S64MB;
+
+    despertarAlInicializar();
+    S25FL_InitDriver(s25flDriverStruct);
+    S25FL_setAsyncRead(NULL, NULL);
 }
 
 void tearDown(void) {
 }
 
 /**
- * @brief Prueba de inicializacion del driver para la memoria flash.
+ * @brief Prueba de inicializacion del driver para la memoria flash. Siempre se
+ *        despierta a la memoria, por si quedo en bajo consumo antes de un reset.
  * 
  */
 void test_inicializar_driver(void) {
     bool result = false;
 
+    despertarAlInicializar();
     result = S25FL_InitDriver(s25flDriverStruct);
     
     TEST_ASSERT_EQUAL(true, result);
@@ -174,3 +194,328 @@ void test_falla_escritura_pagina(void) {
     writeLen = S25FL_writePage(addr, writeBuff, len, fastQuit);
     TEST_ASSERT_EQUAL_UINT32(ERROR_ESCRITURA, writeLen);         
 }
+
+/**
+ * @brief Productor de prueba que entrega los datos en fragmentos de 4 bytes.
+ * 
+ */
+static uint32_t productorFragmentos(void *ctx, uint8_t **data, uint32_t maxLen) {
+    static uint8_t datos[] = "Fragmentado";
+    uint32_t *offset = (uint32_t *)ctx;
+    uint32_t len = 4;
+
+    if (len > maxLen) len = maxLen;
+    *data = &datos[*offset];
+    *offset += len;
+
+    return len;
+}
+
+/**
+ * @brief Prueba de la escritura de datos entregados por un productor en varios
+ *        fragmentos dentro de una misma pagina.
+ * 
+ */
+void test_escritura_stream(void) {
+    uint32_t addr = 512;
+    uint32_t offset = 0;
+    uint32_t len = 10, writeLen = 0;
+
+    delay_CIAA_port_Ignore();   // Se ignora la funcion para generar los delays de hardware
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_WRITEENABLE);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_PAGEPROG);
+    spiWrite_CIAA_port_Ignore();  // Se ignoran la direccion y los fragmentos de datos
+    chipSelect_CIAA_port_Expect(CS_DISABLE); // Todos los fragmentos se envian en un solo comando de programacion
+
+    writeLen = S25FL_writeStream(addr, productorFragmentos, &offset, len);
+
+    TEST_ASSERT_EQUAL_UINT32(len, writeLen);
+    TEST_ASSERT_EQUAL_UINT32(len, offset);
+}
+
+/**
+ * @brief Callback de prueba que cuenta los fragmentos y bytes recibidos.
+ * 
+ */
+static uint32_t fragmentosRecibidos, bytesRecibidos;
+
+static uint32_t consumidorFragmentos(void *ctx, uint32_t address, uint8_t *data, uint32_t len) {
+    (void)ctx;
+    (void)address;
+    (void)data;
+
+    fragmentosRecibidos++;
+    bytesRecibidos += len;
+
+    return len;
+}
+
+/**
+ * @brief Prueba de la lectura masiva en fragmentos: toda la region se lee con
+ *        un solo comando y cada fragmento se entrega al callback.
+ * 
+ */
+void test_lectura_pipeline(void) {
+    uint32_t addr = 2048;
+    uint8_t bufA[8], bufB[8];
+    uint32_t len = 20, readLen = 0;
+
+    fragmentosRecibidos = 0;
+    bytesRecibidos = 0;
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(SPIFLASH_SPI_DATAREAD);
+    spiWrite_CIAA_port_Ignore();  // Se ignora la escritura de la direccion
+
+    // Se leen 3 fragmentos de 8, 8 y 4 bytes
+    spiRead_CIAA_port_ExpectAndReturn(bufA, 8, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ExpectAndReturn(bufB, 8, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ExpectAndReturn(bufA, 4, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    readLen = S25FL_readPipelined(addr, len, bufA, bufB, sizeof(bufA), consumidorFragmentos, NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(len, readLen);
+    TEST_ASSERT_EQUAL_UINT32(3, fragmentosRecibidos);
+    TEST_ASSERT_EQUAL_UINT32(len, bytesRecibidos);
+}
+
+/**
+ * @brief Prueba la lectura masiva con un port que provee lectura asincronica:
+ *        la transferencia de cada fragmento se lanza antes de esperar a que
+ *        termine la anterior y de procesarla.
+ * 
+ */
+void test_lectura_pipeline_asincronica(void) {
+    uint32_t addr = 2048;
+    uint8_t bufA[8], bufB[8];
+    uint32_t len = 20, readLen = 0;
+
+    S25FL_setAsyncRead(spiReadAsync_CIAA_port, spiWait_CIAA_port);
+
+    fragmentosRecibidos = 0;
+    bytesRecibidos = 0;
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(SPIFLASH_SPI_DATAREAD);
+    spiWrite_CIAA_port_Ignore();
+
+    spiReadAsync_CIAA_port_ExpectAndReturn(bufA, 8, true);  // Primer fragmento
+    spiReadAsync_CIAA_port_IgnoreArg_buffer();
+    spiWait_CIAA_port_ExpectAndReturn(true);
+    spiReadAsync_CIAA_port_ExpectAndReturn(bufB, 8, true);  // Se lanza el segundo antes de procesar el primero
+    spiReadAsync_CIAA_port_IgnoreArg_buffer();
+    spiWait_CIAA_port_ExpectAndReturn(true);
+    spiReadAsync_CIAA_port_ExpectAndReturn(bufA, 4, true);  // Se lanza el tercero antes de procesar el segundo
+    spiReadAsync_CIAA_port_IgnoreArg_buffer();
+    spiWait_CIAA_port_ExpectAndReturn(true);
+
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    readLen = S25FL_readPipelined(addr, len, bufA, bufB, sizeof(bufA), consumidorFragmentos, NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(len, readLen);
+    TEST_ASSERT_EQUAL_UINT32(3, fragmentosRecibidos);
+    TEST_ASSERT_EQUAL_UINT32(len, bytesRecibidos);
+}
+
+/**
+ * @brief Callback de prueba que prepara los datos de cada pagina.
+ * 
+ */
+static uint32_t paginasPreparadas;
+
+static uint32_t preparadorPaginas(void *ctx, uint32_t address, uint8_t *data, uint32_t len) {
+    (void)ctx;
+    (void)address;
+
+    memset(data, 0xA5, len);
+    paginasPreparadas++;
+
+    return len;
+}
+
+/**
+ * @brief Simula la lectura del registro de estado con el valor indicado.
+ * 
+ */
+static void leerEstado(uint8_t *estado) {
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_READSTAT1);
+    spiRead_CIAA_port_ExpectAndReturn(estado, 1, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ReturnArrayThruPtr_buffer(estado, 1);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+}
+
+/**
+ * @brief Simula la lectura del registro de estado indicando que la memoria esta libre.
+ * 
+ */
+static void esperarEstadoLibre(void) {
+    static uint8_t libre[] = {0};
+
+    leerEstado(libre);
+}
+
+/**
+ * @brief Simula el comando de programacion de una pagina sin espera final. La
+ *        habilitacion de escritura se confirma leyendo el registro de estado.
+ * 
+ */
+static void programarPagina(void) {
+    static uint8_t ocupada[] = {SPIFLASH_STAT_BUSY};
+    static uint8_t habilitada[] = {SPIFLASH_STAT_WRTEN};
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_WRITEENABLE);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    leerEstado(ocupada);        // El bit de escritura todavia no se activo
+    leerEstado(habilitada);
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_PAGEPROG);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+}
+
+/**
+ * @brief Prueba la escritura masiva de dos paginas: la segunda se prepara
+ *        mientras se programa la primera y cada pagina se confirma leyendo el
+ *        registro de estado, sin demoras fijas.
+ * 
+ */
+void test_escritura_pipeline(void) {
+    uint8_t bufA[S25FL_PAGESIZE], bufB[S25FL_PAGESIZE];
+    uint32_t addr = S25FL_PAGESIZE - 4;     // 4 bytes en cada pagina
+    uint32_t len = 8, writeLen = 0;
+
+    paginasPreparadas = 0;
+
+    spiWrite_CIAA_port_Ignore();    // No se espera ninguna llamada a delay_CIAA_port
+
+    programarPagina();
+    esperarEstadoLibre();
+    programarPagina();
+    esperarEstadoLibre();
+
+    writeLen = S25FL_writePipelined(addr, len, bufA, bufB, preparadorPaginas, NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(len, writeLen);
+    TEST_ASSERT_EQUAL_UINT32(2, paginasPreparadas);
+}
+
+/**
+ * @brief Prueba que la actualizacion de una region con los mismos datos que ya
+ *        contiene la memoria no escriba ni borre nada.
+ * 
+ */
+void test_actualizacion_sin_cambios(void) {
+    uint32_t addr = 4096;
+    uint8_t datos[] = "Sin cambios";
+    uint8_t sectorBuff[S25FL_SECTORSIZE];
+    uint32_t len = sizeof(datos), updateLen = 0;
+
+    // Solo se debe leer el contenido actual de la region
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(SPIFLASH_SPI_DATAREAD);
+    spiWrite_CIAA_port_Ignore();
+    spiRead_CIAA_port_ExpectAndReturn(sectorBuff, len, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ReturnArrayThruPtr_buffer(datos, len);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    updateLen = S25FL_updateRange(addr, datos, len, sectorBuff);
+
+    TEST_ASSERT_EQUAL_UINT32(len, updateLen);
+}
+
+/**
+ * @brief Prueba que luego de entrar en bajo consumo el siguiente acceso despierte
+ *        a la memoria y espere tRES antes de enviar el comando.
+ * 
+ */
+void test_despertar_transparente(void) {
+    uint8_t rxBuff[] = {0}, estado = 0xFF;
+
+    // Se chequea que la memoria no este ocupada antes de apagarla
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_READSTAT1);
+    spiRead_CIAA_port_ExpectAndReturn(rxBuff, 1, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ReturnArrayThruPtr_buffer(rxBuff, 1);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_POWERDOWN);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    TEST_ASSERT_TRUE(S25FL_powerDown());
+
+    // El proximo acceso despierta a la memoria y espera tRES
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_RPWRDDEVID);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    delay_CIAA_port_Expect(S25FL_WAKE_DELAY);
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_READSTAT1);
+    spiRead_CIAA_port_ExpectAndReturn(rxBuff, 1, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ReturnArrayThruPtr_buffer(rxBuff, 1);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    estado = S25FL_readStatus();
+
+    TEST_ASSERT_EQUAL_UINT8(0, estado);
+}
+
+/**
+ * @brief Prueba que con direcciones de 24 bits la memoria de 256 Mb quede
+ *        limitada a los primeros 16 MB.
+ * 
+ */
+void test_geometria_limitada_por_direccion(void) {
+    uint8_t writeBuff[8] = {0};
+
+    s25flDriverStruct.memory_size = S256MB;
+    despertarAlInicializar();
+    TEST_ASSERT_TRUE(S25FL_InitDriver(s25flDriverStruct));
+
+    TEST_ASSERT_EQUAL_INT32(65536, S25FL_numPages());
+
+    // Los sectores y paginas por encima de 16 MB se rechazan sin acceder a la memoria
+    TEST_ASSERT_FALSE(S25FL_eraseSector(4096));
+    TEST_ASSERT_EQUAL_UINT32(ERROR_ESCRITURA, S25FL_writePage(0x1000000, writeBuff, sizeof(writeBuff), false));
+}
+
+/**
+ * @brief Prueba la escritura de una pagina por encima de los 8 MB en la
+ *        memoria de 128 Mb.
+ * 
+ */
+void test_escritura_pagina_sobre_8MB(void) {
+    uint32_t addr = 0x900000;
+    uint8_t writeBuff[8] = "Probando";
+    uint32_t len = 8;
+
+    s25flDriverStruct.memory_size = S128MB;
+    despertarAlInicializar();
+    TEST_ASSERT_TRUE(S25FL_InitDriver(s25flDriverStruct));
+
+    delay_CIAA_port_Ignore();
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_WRITEENABLE);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_PAGEPROG);
+    spiWrite_CIAA_port_Ignore();
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    TEST_ASSERT_EQUAL_UINT32(len, S25FL_writePage(addr, writeBuff, len, false));
+}
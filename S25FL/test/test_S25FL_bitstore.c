@@ -0,0 +1,186 @@
+/*
+ *  test_S25FL_bitstore.c
+ *
+ * Prueba de los contadores y mapas de bits sin borrado (S25FL_bitstore.c)
+ * sobre una memoria S25FL064L simulada en el host.
+ * 
+ */
+
+#include "unity.h"
+#include "S25FL.h"
+#include "S25FL_bitstore.h"
+#include "S25FL_sim.h"
+#include <string.h>
+
+#define SECTOR_A        10
+#define SECTOR_B        11
+#define SECTOR_BITMAP   20
+
+void setUp(void) {
+    S25FL_sim_reset();
+    S25FL_InitDriver(S25FL_sim_driverConfig());
+}
+
+void tearDown(void) {
+}
+
+/**
+ * @brief Prueba que cada incremento programe un solo byte sin borrar la memoria.
+ * 
+ */
+void test_contador_incremento_sin_borrado(void) {
+    s25fl_counter_t counter;
+    s25fl_sim_stats_t antes, despues;
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_counterValue(&counter));
+
+    antes = S25FL_sim_stats();
+    TEST_ASSERT_TRUE(S25FL_counterIncrement(&counter));
+    despues = S25FL_sim_stats();
+
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_counterValue(&counter));
+    TEST_ASSERT_EQUAL_UINT32(antes.pageProgs + 1, despues.pageProgs);
+    TEST_ASSERT_EQUAL_UINT32(antes.sectorErases, despues.sectorErases);
+}
+
+/**
+ * @brief Prueba que el valor del contador se recupere al volver a inicializarlo,
+ *        incluso despues de saturar un sector.
+ * 
+ */
+void test_contador_recupera_valor(void) {
+    s25fl_counter_t counter;
+    uint32_t i, valor = S25FL_COUNTER_BITS + 10;
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    for (i = 0; i < valor; i++)
+    {
+        TEST_ASSERT_TRUE(S25FL_counterIncrement(&counter));
+    }
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    TEST_ASSERT_EQUAL_UINT32(valor, S25FL_counterValue(&counter));
+}
+
+/**
+ * @brief Prueba que una cabecera danada por un borrado interrumpido del sector
+ *        anterior no haga saltar el valor del contador.
+ * 
+ */
+void test_contador_descarta_cabecera_borrado_interrumpido(void) {
+    s25fl_counter_t counter;
+    uint32_t i, valor = S25FL_COUNTER_BITS + 10;
+    // Cabecera con base 0 en la que el borrado solo llego a poner en 1 algunos bits
+    uint8_t cabeceraDanada[S25FL_COUNTER_HEADER_SIZE] = {0x00, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF};
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    for (i = 0; i < valor; i++)
+    {
+        TEST_ASSERT_TRUE(S25FL_counterIncrement(&counter));
+    }
+
+    // Se simula el corte de alimentacion durante el borrado del sector A
+    memcpy(&S25FL_sim_memory()[SECTOR_A * S25FL_SECTORSIZE], cabeceraDanada, sizeof(cabeceraDanada));
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    TEST_ASSERT_EQUAL_UINT32(valor, S25FL_counterValue(&counter));
+}
+
+/**
+ * @brief Prueba que una cabecera programada a medias en el sector nuevo se
+ *        descarte y el contador siga desde el sector anterior.
+ * 
+ */
+void test_contador_descarta_cabecera_incompleta(void) {
+    s25fl_counter_t counter;
+    uint32_t i;
+    // Solo se llegaron a programar los dos primeros bytes de la base
+    uint8_t cabeceraIncompleta[2] = {S25FL_COUNTER_BITS & 0xFF, (S25FL_COUNTER_BITS >> 8) & 0xFF};
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    for (i = 0; i < S25FL_COUNTER_BITS; i++)
+    {
+        TEST_ASSERT_TRUE(S25FL_counterIncrement(&counter));
+    }
+
+    memcpy(&S25FL_sim_memory()[SECTOR_B * S25FL_SECTORSIZE], cabeceraIncompleta, sizeof(cabeceraIncompleta));
+
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    TEST_ASSERT_EQUAL_UINT32(S25FL_COUNTER_BITS, S25FL_counterValue(&counter));
+
+    // El siguiente incremento vuelve a escribir la cabecera del sector B
+    TEST_ASSERT_TRUE(S25FL_counterIncrement(&counter));
+    TEST_ASSERT_TRUE(S25FL_counterInit(&counter, SECTOR_A, SECTOR_B));
+    TEST_ASSERT_EQUAL_UINT32(S25FL_COUNTER_BITS + 1, S25FL_counterValue(&counter));
+}
+
+/**
+ * @brief Prueba la reserva de bits del mapa y la busqueda del proximo libre.
+ * 
+ */
+void test_mapa_bits_reserva_y_busqueda(void) {
+    s25fl_bitmap_t bitmap;
+    uint32_t i;
+
+    TEST_ASSERT_TRUE(S25FL_bitmapInit(&bitmap, SECTOR_BITMAP, 4000));
+    TEST_ASSERT_EQUAL_INT32(0, S25FL_bitmapFindSet(&bitmap, 0));
+
+    for (i = 0; i < 2500; i++)
+    {
+        TEST_ASSERT_TRUE(S25FL_bitmapClear(&bitmap, i));
+    }
+
+    TEST_ASSERT_FALSE(S25FL_bitmapTest(&bitmap, 2499));
+    TEST_ASSERT_TRUE(S25FL_bitmapTest(&bitmap, 2500));
+    TEST_ASSERT_EQUAL_INT32(2500, S25FL_bitmapFindSet(&bitmap, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_sim_stats().sectorErases);
+}
+
+/**
+ * @brief Prueba que un mapa saturado se libere completo al reiniciarlo.
+ * 
+ */
+void test_mapa_bits_saturado(void) {
+    s25fl_bitmap_t bitmap;
+    uint32_t i;
+
+    TEST_ASSERT_TRUE(S25FL_bitmapInit(&bitmap, SECTOR_BITMAP, 64));
+    for (i = 0; i < 64; i++)
+    {
+        TEST_ASSERT_TRUE(S25FL_bitmapClear(&bitmap, i));
+    }
+    TEST_ASSERT_EQUAL_INT32(-1, S25FL_bitmapFindSet(&bitmap, 0));
+
+    TEST_ASSERT_TRUE(S25FL_bitmapReset(&bitmap));
+    TEST_ASSERT_EQUAL_INT32(0, S25FL_bitmapFindSet(&bitmap, 0));
+}
+
+/**
+ * @brief Prueba que un mapa sobre una region con datos previos los vea como
+ *        bits ocupados hasta reiniciarlo, y que luego se recupere al volver
+ *        a inicializarlo.
+ * 
+ */
+void test_mapa_bits_region_usada(void) {
+    s25fl_bitmap_t bitmap;
+    uint8_t datosPrevios[2] = {0x12, 0x00};
+
+    memcpy(&S25FL_sim_memory()[SECTOR_BITMAP * S25FL_SECTORSIZE], datosPrevios, sizeof(datosPrevios));
+
+    TEST_ASSERT_TRUE(S25FL_bitmapInit(&bitmap, SECTOR_BITMAP, 64));
+    TEST_ASSERT_FALSE(S25FL_bitmapTest(&bitmap, 0));
+    TEST_ASSERT_EQUAL_INT32(3, S25FL_bitmapFindSet(&bitmap, 0));
+    TEST_ASSERT_EQUAL_INT32(6, S25FL_bitmapFindSet(&bitmap, 4));
+    TEST_ASSERT_EQUAL_INT32(16, S25FL_bitmapFindSet(&bitmap, 7));
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_sim_stats().sectorErases);
+
+    TEST_ASSERT_TRUE(S25FL_bitmapReset(&bitmap));
+    TEST_ASSERT_EQUAL_INT32(0, S25FL_bitmapFindSet(&bitmap, 0));
+    TEST_ASSERT_TRUE(S25FL_bitmapTest(&bitmap, 8));
+
+    TEST_ASSERT_TRUE(S25FL_bitmapClear(&bitmap, 5));
+    TEST_ASSERT_TRUE(S25FL_bitmapInit(&bitmap, SECTOR_BITMAP, 64));
+    TEST_ASSERT_FALSE(S25FL_bitmapTest(&bitmap, 5));
+    TEST_ASSERT_EQUAL_INT32(0, S25FL_bitmapFindSet(&bitmap, 0));
+}
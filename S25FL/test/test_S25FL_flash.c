@@ -0,0 +1,448 @@
+/*
+ *  test_S25FL_flash.c
+ *
+ * Pruebas del driver S25FL.c sobre una memoria S25FL064L simulada en el host,
+ * para las operaciones cuyo resultado se verifica en el contenido de la flash.
+ * 
+ */
+
+#include "unity.h"
+#include "S25FL.h"
+#include "S25FL_sim.h"
+#include <string.h>
+
+void setUp(void) {
+    S25FL_sim_reset();
+    S25FL_InitDriver(S25FL_sim_driverConfig());
+    S25FL_setTickFnc(NULL);
+}
+
+void tearDown(void) {
+}
+
+/**
+ * @brief Productor de prueba que entrega los datos en fragmentos de 100 bytes.
+ * 
+ */
+static uint8_t datosStream[600];
+
+static uint32_t productorFragmentos(void *ctx, uint8_t **data, uint32_t maxLen) {
+    uint32_t *offset = (uint32_t *)ctx;
+    uint32_t len = 100;
+
+    if (len > maxLen) len = maxLen;
+    if (len > sizeof(datosStream) - *offset) len = sizeof(datosStream) - *offset;
+    *data = &datosStream[*offset];
+    *offset += len;
+
+    return len;
+}
+
+/**
+ * @brief Prueba la escritura de un flujo que abarca varias paginas: cada pagina
+ *        se programa con un solo comando aunque reciba varios fragmentos.
+ * 
+ */
+void test_escritura_stream_varias_paginas(void) {
+    uint32_t addr = 3 * S25FL_PAGESIZE + 200;
+    uint32_t offset = 0, i;
+
+    for (i = 0; i < sizeof(datosStream); i++) datosStream[i] = (uint8_t)(i * 7 + 1);
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datosStream), S25FL_writeStream(addr, productorFragmentos, &offset, sizeof(datosStream)));
+
+    // 56 bytes en la primera pagina, 2 paginas completas y 32 bytes en la ultima
+    TEST_ASSERT_EQUAL_UINT32(4, S25FL_sim_stats().pageProgs);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datosStream), offset);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datosStream, &S25FL_sim_memory()[addr], sizeof(datosStream));
+}
+
+/**
+ * @brief Prueba que un flujo "hasta el final" se limite al final de la memoria,
+ *        sin dar la vuelta al principio.
+ * 
+ */
+void test_escritura_stream_hasta_el_final(void) {
+    uint32_t addr = S25FL_SIM_SIZE - 16;
+    uint32_t offset = 0, i;
+
+    for (i = 0; i < sizeof(datosStream); i++) datosStream[i] = (uint8_t)(i + 0x20);
+
+    TEST_ASSERT_EQUAL_UINT32(16, S25FL_writeStream(addr, productorFragmentos, &offset, UINT32_MAX));
+
+    TEST_ASSERT_EQUAL_UINT32(16, offset);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datosStream, &S25FL_sim_memory()[addr], 16);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, S25FL_sim_memory()[0]);
+}
+
+/**
+ * @brief Prueba la escritura desde un buffer circular cuando los datos dan la
+ *        vuelta al final del buffer y cruzan un limite de pagina.
+ * 
+ */
+void test_escritura_buffer_circular(void) {
+    uint8_t datos[64];
+    uint8_t esperado[40];
+    s25fl_ring_t ring;
+    uint32_t addr = 5 * S25FL_PAGESIZE - 20;   // 20 bytes antes del limite de pagina
+    uint32_t i;
+
+    for (i = 0; i < sizeof(datos); i++) datos[i] = (uint8_t)(0x80 + i);
+    for (i = 0; i < sizeof(esperado); i++) esperado[i] = datos[(50 + i) % sizeof(datos)];
+
+    ring.buffer = datos;
+    ring.size = sizeof(datos);
+    ring.tail = 50;     // El buffer da la vuelta luego de 14 bytes
+    ring.head = (50 + sizeof(esperado)) % sizeof(datos);
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(esperado), S25FL_writeRing(addr, &ring, sizeof(esperado)));
+
+    TEST_ASSERT_EQUAL_UINT32((50 + sizeof(esperado)) % sizeof(datos), ring.tail);
+    TEST_ASSERT_EQUAL_UINT32(2, S25FL_sim_stats().pageProgs);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(esperado, &S25FL_sim_memory()[addr], sizeof(esperado));
+}
+
+/**
+ * @brief Prueba que desde un buffer circular solo se escriban los bytes que el
+ *        productor ya cargo, aunque se pidan mas.
+ * 
+ */
+void test_escritura_buffer_circular_limitada_por_head(void) {
+    uint8_t datos[64];
+    s25fl_ring_t ring;
+    uint32_t addr = 6 * S25FL_PAGESIZE;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(datos); i++) datos[i] = (uint8_t)i;
+
+    ring.buffer = datos;
+    ring.size = sizeof(datos);
+    ring.tail = 60;
+    ring.head = 60;     // Buffer vacio
+
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_writeRing(addr, &ring, 20));
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_sim_stats().pageProgs);
+
+    ring.head = 6;      // El productor cargo 10 bytes, dando la vuelta
+
+    TEST_ASSERT_EQUAL_UINT32(10, S25FL_writeRing(addr, &ring, 20));
+    TEST_ASSERT_EQUAL_UINT32(ring.head, ring.tail);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&datos[60], &S25FL_sim_memory()[addr], 4);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datos, &S25FL_sim_memory()[addr + 4], 6);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, S25FL_sim_memory()[addr + 10]);
+}
+
+/**
+ * @brief Callback de prueba que copia en cada pagina los datos de origen.
+ * 
+ */
+static uint8_t datosOrigen[600];
+static uint32_t direccionOrigen;
+
+static uint32_t preparadorPaginas(void *ctx, uint32_t address, uint8_t *data, uint32_t len) {
+    (void)ctx;
+
+    memcpy(data, &datosOrigen[address - direccionOrigen], len);
+
+    return len;
+}
+
+/**
+ * @brief Prueba que la escritura masiva deje en la flash los datos preparados,
+ *        sin demoras fijas por pagina.
+ * 
+ */
+void test_escritura_pipeline(void) {
+    uint8_t bufA[S25FL_PAGESIZE], bufB[S25FL_PAGESIZE];
+    uint32_t i, inicio;
+
+    direccionOrigen = 2 * S25FL_PAGESIZE + 100;
+    for (i = 0; i < sizeof(datosOrigen); i++) datosOrigen[i] = (uint8_t)(i * 3 + 5);
+
+    inicio = S25FL_sim_tick();
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datosOrigen),
+        S25FL_writePipelined(direccionOrigen, sizeof(datosOrigen), bufA, bufB, preparadorPaginas, NULL));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datosOrigen, &S25FL_sim_memory()[direccionOrigen], sizeof(datosOrigen));
+    TEST_ASSERT_EQUAL_UINT32(inicio, S25FL_sim_tick());
+}
+
+/**
+ * @brief Prueba que si la ultima pagina no termina de programarse, sus bytes
+ *        no se cuenten como escritos.
+ * 
+ */
+void test_escritura_pipeline_timeout(void) {
+    uint8_t bufA[S25FL_PAGESIZE], bufB[S25FL_PAGESIZE];
+
+    direccionOrigen = 0;
+    S25FL_sim_setBusy(true);
+
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_writePipelined(0, 16, bufA, bufB, preparadorPaginas, NULL));
+}
+
+/**
+ * @brief Callback de prueba que cuenta los bytes leidos.
+ * 
+ */
+static uint32_t bytesRecibidos;
+
+static uint32_t consumidorFragmentos(void *ctx, uint32_t address, uint8_t *data, uint32_t len) {
+    (void)ctx;
+    (void)address;
+    (void)data;
+
+    bytesRecibidos += len;
+
+    return len;
+}
+
+/**
+ * @brief Prueba que una lectura y una escritura masivas "hasta el final" se
+ *        limiten al final de la memoria, sin dar la vuelta al principio.
+ * 
+ */
+void test_pipeline_hasta_el_final(void) {
+    uint8_t bufA[S25FL_PAGESIZE], bufB[S25FL_PAGESIZE];
+    uint32_t addr = S25FL_SIM_SIZE - 16;
+    uint32_t i;
+
+    direccionOrigen = addr;
+    for (i = 0; i < 16; i++) datosOrigen[i] = (uint8_t)(0xC0 + i);
+
+    TEST_ASSERT_EQUAL_UINT32(16, S25FL_writePipelined(addr, UINT32_MAX, bufA, bufB, preparadorPaginas, NULL));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datosOrigen, &S25FL_sim_memory()[addr], 16);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, S25FL_sim_memory()[0]);
+
+    bytesRecibidos = 0;
+    TEST_ASSERT_EQUAL_UINT32(16, S25FL_readPipelined(addr, UINT32_MAX, bufA, bufB, sizeof(bufA), consumidorFragmentos, NULL));
+    TEST_ASSERT_EQUAL_UINT32(16, bytesRecibidos);
+    TEST_ASSERT_EQUAL_UINT32(16, S25FL_sim_stats().bytesRead);
+}
+
+/**
+ * @brief Prueba la actualizacion que solo requiere pasar bits de 1 a 0: se
+ *        programa unicamente la pagina que cambia y no se borra el sector.
+ * 
+ */
+void test_actualizacion_sin_borrado(void) {
+    uint8_t datos[3 * S25FL_PAGESIZE];
+    uint8_t sectorBuff[S25FL_SECTORSIZE];
+    uint32_t addr = S25FL_SECTORSIZE;
+    uint32_t i;
+    s25fl_sim_stats_t antes;
+
+    for (i = 0; i < sizeof(datos); i++) datos[i] = (uint8_t)(i | 0x0F);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datos), S25FL_writeBuffer(addr, datos, sizeof(datos)));
+
+    // Solo cambia un byte de la segunda pagina, y solo borrando bits
+    datos[S25FL_PAGESIZE + 10] &= 0xF0;
+    antes = S25FL_sim_stats();
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datos), S25FL_updateRange(addr, datos, sizeof(datos), sectorBuff));
+
+    TEST_ASSERT_EQUAL_UINT32(antes.pageProgs + 1, S25FL_sim_stats().pageProgs);
+    TEST_ASSERT_EQUAL_UINT32(antes.sectorErases, S25FL_sim_stats().sectorErases);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datos, &S25FL_sim_memory()[addr], sizeof(datos));
+}
+
+/**
+ * @brief Prueba la actualizacion que requiere pasar bits de 0 a 1: se borra el
+ *        sector y se preservan los datos que estan fuera de la region, a ambos
+ *        lados de ella.
+ * 
+ */
+void test_actualizacion_con_borrado_preserva_sector(void) {
+    static uint8_t sector[S25FL_SECTORSIZE];
+    uint8_t sectorBuff[S25FL_SECTORSIZE];
+    uint8_t nuevos[500];
+    uint32_t addr = 4 * S25FL_SECTORSIZE;
+    uint32_t offset = 1000;
+    uint32_t i;
+    s25fl_sim_stats_t antes;
+
+    for (i = 0; i < sizeof(sector); i++) sector[i] = (uint8_t)(i * 5);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(sector), S25FL_writeBuffer(addr, sector, sizeof(sector)));
+
+    for (i = 0; i < sizeof(nuevos); i++) nuevos[i] = 0xFF - (uint8_t)i;
+    antes = S25FL_sim_stats();
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(nuevos), S25FL_updateRange(addr + offset, nuevos, sizeof(nuevos), sectorBuff));
+
+    // Se borra una vez y se reescriben las 16 paginas del sector
+    TEST_ASSERT_EQUAL_UINT32(antes.sectorErases + 1, S25FL_sim_stats().sectorErases);
+    TEST_ASSERT_EQUAL_UINT32(antes.pageProgs + S25FL_SECTORSIZE / S25FL_PAGESIZE, S25FL_sim_stats().pageProgs);
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(sector, &S25FL_sim_memory()[addr], offset);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(nuevos, &S25FL_sim_memory()[addr + offset], sizeof(nuevos));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&sector[offset + sizeof(nuevos)], &S25FL_sim_memory()[addr + offset + sizeof(nuevos)],
+                                  S25FL_SECTORSIZE - offset - sizeof(nuevos));
+}
+
+/**
+ * @brief Prueba una region que cruza dos sectores: solo se borra el sector que
+ *        necesita transiciones de 0 a 1, y las paginas en blanco no se programan.
+ * 
+ */
+void test_actualizacion_borra_solo_sector_necesario(void) {
+    uint8_t sectorBuff[S25FL_SECTORSIZE];
+    uint8_t datos[200];
+    uint8_t cero = 0x00;
+    uint32_t addr = 8 * S25FL_SECTORSIZE - 100;    // 100 bytes en cada sector
+    uint32_t i;
+    s25fl_sim_stats_t antes;
+
+    // Un byte en 0 en el segundo sector, el resto de ambos sectores en blanco
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_writePage(addr + 150, &cero, 1, false));
+
+    for (i = 0; i < sizeof(datos); i++) datos[i] = 0xF0;
+    antes = S25FL_sim_stats();
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datos), S25FL_updateRange(addr, datos, sizeof(datos), sectorBuff));
+
+    // Primer sector: una pagina programada sin borrar. Segundo sector: borrado
+    // y una sola pagina programada, ya que las demas quedan en blanco.
+    TEST_ASSERT_EQUAL_UINT32(antes.sectorErases + 1, S25FL_sim_stats().sectorErases);
+    TEST_ASSERT_EQUAL_UINT32(antes.pageProgs + 2, S25FL_sim_stats().pageProgs);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datos, &S25FL_sim_memory()[addr], sizeof(datos));
+}
+
+/**
+ * @brief Prueba que una actualizacion con una longitud que supera el final de
+ *        la memoria se limite al ultimo sector, sin dar la vuelta al principio.
+ * 
+ */
+void test_actualizacion_hasta_el_final(void) {
+    uint8_t sectorBuff[S25FL_SECTORSIZE];
+    uint8_t datos[16];
+    uint32_t addr = S25FL_SIM_SIZE - sizeof(datos);
+    uint32_t i;
+
+    for (i = 0; i < sizeof(datos); i++) datos[i] = (uint8_t)(0x30 + i);
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(datos), S25FL_updateRange(addr, datos, UINT32_MAX, sectorBuff));
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(datos, &S25FL_sim_memory()[addr], sizeof(datos));
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_sim_stats().pageProgs);
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_sim_stats().sectorErases);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, S25FL_sim_memory()[0]);
+}
+
+/**
+ * @brief Prueba que S25FL_powerTask ponga a la memoria en bajo consumo recien
+ *        cuando se cumple el tiempo de inactividad, y que el siguiente acceso
+ *        la despierte sin que el llamador lo note.
+ * 
+ */
+void test_apagado_por_inactividad(void) {
+    uint8_t dato = 0x5A, leido = 0;
+
+    S25FL_setTickFnc(S25FL_sim_tick);    // Se usa el tiempo simulado como base de tiempo
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_writePage(100, &dato, 1, false));
+    S25FL_setIdleTimeout(50);
+
+    // El tiempo de inactividad se cuenta desde el ultimo acceso
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_readBuffer(100, &leido, 1));
+    leido = 0;
+
+    S25FL_sim_advance(49);
+    S25FL_powerTask();
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_sim_stats().powerDowns);
+
+    S25FL_sim_advance(1);
+    S25FL_powerTask();
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_sim_stats().powerDowns);
+
+    // Se vuelve a llamar a la tarea sin accesos: no se repite el comando
+    S25FL_sim_advance(100);
+    S25FL_powerTask();
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_sim_stats().powerDowns);
+
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_readBuffer(100, &leido, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_sim_stats().wakes);
+    TEST_ASSERT_EQUAL_HEX8(dato, leido);
+}
+
+/**
+ * @brief Prueba que sin S25FL_prefetchWake el primer acceso espere tRES, y que
+ *        con el despertar anticipado no espere si ya paso el tiempo necesario.
+ * 
+ */
+void test_despertar_anticipado_evita_espera(void) {
+    uint8_t leido;
+    uint32_t inicio;
+    s25fl_power_stats_t stats;
+
+    S25FL_setTickFnc(S25FL_sim_tick);
+
+    // Sin despertar anticipado, el acceso espera tRES
+    TEST_ASSERT_TRUE(S25FL_powerDown());
+    inicio = S25FL_sim_tick();
+    S25FL_readBuffer(0, &leido, 1);
+    TEST_ASSERT_EQUAL_UINT32(inicio + S25FL_WAKE_DELAY, S25FL_sim_tick());
+
+    // Con despertar anticipado y tiempo suficiente, el acceso no espera
+    TEST_ASSERT_TRUE(S25FL_powerDown());
+    S25FL_prefetchWake();
+    TEST_ASSERT_EQUAL_UINT32(2, S25FL_sim_stats().wakes);
+    S25FL_sim_advance(S25FL_WAKE_DELAY + 1);
+    inicio = S25FL_sim_tick();
+    S25FL_readBuffer(0, &leido, 1);
+    TEST_ASSERT_EQUAL_UINT32(inicio, S25FL_sim_tick());
+
+    S25FL_getPowerStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.prefetchWakes);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.wakeStalls);
+}
+
+/**
+ * @brief Prueba los contadores de S25FL_getPowerStats, incluyendo el tiempo en
+ *        bajo consumo en curso.
+ * 
+ */
+void test_estadisticas_energia(void) {
+    uint8_t leido;
+    s25fl_power_stats_t stats;
+
+    S25FL_setTickFnc(S25FL_sim_tick);
+
+    TEST_ASSERT_TRUE(S25FL_powerDown());
+    S25FL_sim_advance(100);
+    S25FL_readBuffer(0, &leido, 1);     // Despierta y espera tRES
+
+    TEST_ASSERT_TRUE(S25FL_powerDown());
+    S25FL_sim_advance(30);
+
+    S25FL_getPowerStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.powerDowns);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.wakes);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.prefetchWakes);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.wakeStalls);
+    TEST_ASSERT_EQUAL_UINT32(S25FL_WAKE_DELAY, stats.wakeWaitTime);
+    TEST_ASSERT_EQUAL_UINT32(100 + 30, stats.residency);
+}
+
+/**
+ * @brief Prueba que al inicializar el driver con la memoria en bajo consumo,
+ *        como luego de un reset del microcontrolador, se la despierte y se
+ *        deshabilite el apagado automatico.
+ * 
+ */
+void test_inicializar_con_memoria_en_bajo_consumo(void) {
+    uint8_t dato = 0x42, leido = 0;
+
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_writePage(10, &dato, 1, false));
+    S25FL_setIdleTimeout(50);
+    TEST_ASSERT_TRUE(S25FL_powerDown());
+
+    // El driver se reinicia pero la memoria sigue en bajo consumo
+    TEST_ASSERT_TRUE(S25FL_InitDriver(S25FL_sim_driverConfig()));
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_sim_stats().wakes);
+
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_readBuffer(10, &leido, 1));
+    TEST_ASSERT_EQUAL_HEX8(dato, leido);
+
+    S25FL_setTickFnc(S25FL_sim_tick);
+    S25FL_sim_advance(100);
+    S25FL_powerTask();
+    TEST_ASSERT_EQUAL_UINT32(1, S25FL_sim_stats().powerDowns);
+}
@@ -0,0 +1,89 @@
+/*
+ *  test_S25FL_static.c
+ * 
+ * Prueba del driver S25FL.c compilado con el port y la geometria fijos en
+ * tiempo de compilacion. project.yml define S25FL_CONFIG_FILE como
+ * S25FL_config_CIAA.h solo para esta prueba, por lo que el driver llama
+ * directamente a las funciones del port de la CIAA.
+ * 
+ */
+
+#include "unity.h"
+#include "S25FL.h"
+#include "mock_S25FL_CIAA_port.h"
+#include <string.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/**
+ * @brief Prueba que la inicializacion ignore la configuracion recibida: no hay
+ *        punteros a funciones que validar y la geometria es la de S25FL064L.
+ * 
+ */
+void test_inicializacion_ignora_configuracion(void) {
+    s25fl_t config;
+
+    memset(&config, 0, sizeof(config));
+    config.memory_size = S256MB;
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_RPWRDDEVID);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    delay_CIAA_port_Expect(S25FL_WAKE_DELAY);
+
+    TEST_ASSERT_TRUE(S25FL_InitDriver(config));
+
+    TEST_ASSERT_EQUAL_INT32(S25FL_PAGESIZE, S25FL_pageSize());
+    TEST_ASSERT_EQUAL_INT8(24, S25FL_addressSize());
+    TEST_ASSERT_EQUAL_INT32(S25FL_PAGES, S25FL_numPages());
+}
+
+/**
+ * @brief Prueba la lectura de datos llamando directamente al port.
+ * 
+ */
+void test_leyendo_datos(void) {
+    uint8_t readBuff[16] = {0};
+    uint8_t response[] = "Port fijo";
+    uint32_t len = sizeof(response);
+
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(SPIFLASH_SPI_DATAREAD);
+    spiWrite_CIAA_port_Ignore();    // Se ignora la escritura de la direccion
+    spiRead_CIAA_port_ExpectAndReturn(readBuff, len, true);
+    spiRead_CIAA_port_IgnoreArg_buffer();
+    spiRead_CIAA_port_ReturnArrayThruPtr_buffer(response, len);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    TEST_ASSERT_EQUAL_UINT32(len, S25FL_readBuffer(1024, readBuff, len));
+    TEST_ASSERT_EQUAL_STRING(response, readBuff);
+}
+
+/**
+ * @brief Prueba la escritura de una pagina llamando directamente al port, y que
+ *        los limites de la geometria fija se sigan validando.
+ * 
+ */
+void test_escritura_pagina(void) {
+    uint8_t writeBuff[8] = "Probando";
+    uint32_t len = sizeof(writeBuff);
+
+    delay_CIAA_port_Ignore();
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_WRITEENABLE);
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+    chipSelect_CIAA_port_Expect(CS_ENABLE);
+    spiWriteByte_CIAA_port_Expect(S25FL_CMD_PAGEPROG);
+    spiWrite_CIAA_port_Ignore();
+    chipSelect_CIAA_port_Expect(CS_DISABLE);
+
+    TEST_ASSERT_EQUAL_UINT32(len, S25FL_writePage(256, writeBuff, len, false));
+
+    // Fuera de la memoria o cruzando el limite de pagina no se accede al port
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_writePage(S25FL_PAGES * S25FL_PAGESIZE, writeBuff, len, false));
+    TEST_ASSERT_EQUAL_UINT32(0, S25FL_writePage(S25FL_PAGESIZE - 4, writeBuff, len, false));
+}
@@ -0,0 +1,95 @@
+/*
+ *  test_S25FL_lfs.c
+ *
+ * Prueba del adaptador de littlefs (S25FL_lfs.c) sobre una memoria S25FL064L
+ * simulada en el host. Requiere littlefs en vendor/littlefs y se ejecuta con
+ * `ceedling options:littlefs test:all` (ver options/littlefs.yml).
+ * 
+ */
+
+#include "unity.h"
+#include "lfs.h"
+#include "S25FL.h"
+#include "S25FL_lfs.h"
+#include "S25FL_sim.h"
+#include <string.h>
+
+static struct lfs_config cfg;
+static lfs_t lfs;
+
+void setUp(void) {
+    S25FL_sim_reset();
+    S25FL_InitDriver(S25FL_sim_driverConfig());
+    S25FL_lfs_config(&cfg);
+}
+
+void tearDown(void) {
+}
+
+/**
+ * @brief Prueba que la configuracion de littlefs se derive de la geometria de la flash.
+ * 
+ */
+void test_configuracion_desde_geometria(void) {
+    TEST_ASSERT_EQUAL_UINT32(S25FL_pageSize(), cfg.read_size);
+    TEST_ASSERT_EQUAL_UINT32(S25FL_pageSize(), cfg.prog_size);
+    TEST_ASSERT_EQUAL_UINT32(S25FL_pageSize(), cfg.cache_size);
+    TEST_ASSERT_EQUAL_UINT32(S25FL_SECTORSIZE, cfg.block_size);
+    TEST_ASSERT_EQUAL_UINT32(S25FL_SECTORS, cfg.block_count);
+    TEST_ASSERT_EQUAL_UINT32(S25FL_SECTORS / 8, cfg.lookahead_size);
+}
+
+/**
+ * @brief Prueba las operaciones del dispositivo de bloques directamente.
+ * 
+ */
+void test_bloque_programar_leer_borrar(void) {
+    uint8_t writeBuff[S25FL_PAGESIZE * 2];
+    uint8_t readBuff[S25FL_PAGESIZE * 2];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(writeBuff); i++) writeBuff[i] = (uint8_t)i;
+
+    TEST_ASSERT_EQUAL_INT(0, cfg.prog(&cfg, 3, S25FL_PAGESIZE, writeBuff, sizeof(writeBuff)));
+    TEST_ASSERT_EQUAL_INT(0, cfg.read(&cfg, 3, S25FL_PAGESIZE, readBuff, sizeof(readBuff)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(writeBuff, readBuff, sizeof(writeBuff));
+    TEST_ASSERT_EQUAL_UINT32(2, S25FL_sim_stats().pageProgs);
+
+    TEST_ASSERT_EQUAL_INT(0, cfg.erase(&cfg, 3));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, S25FL_sim_memory()[3 * S25FL_SECTORSIZE + S25FL_PAGESIZE]);
+    TEST_ASSERT_EQUAL_INT(0, cfg.sync(&cfg));
+}
+
+/**
+ * @brief Prueba que un bloque fuera de la memoria devuelva error.
+ * 
+ */
+void test_bloque_invalido(void) {
+    TEST_ASSERT_EQUAL_INT(LFS_ERR_IO, cfg.erase(&cfg, cfg.block_count));
+}
+
+/**
+ * @brief Prueba completa de formateo, escritura de un archivo y lectura
+ *        luego de volver a montar el sistema de archivos.
+ * 
+ */
+void test_archivo_persiste_al_remontar(void) {
+    lfs_file_t file;
+    const char datos[] = "Registro de prueba en littlefs";
+    char readBuff[sizeof(datos)] = {0};
+
+    TEST_ASSERT_EQUAL_INT(0, lfs_format(&lfs, &cfg));
+    TEST_ASSERT_EQUAL_INT(0, lfs_mount(&lfs, &cfg));
+    TEST_ASSERT_EQUAL_INT(0, lfs_file_open(&lfs, &file, "log.txt", LFS_O_WRONLY | LFS_O_CREAT));
+    TEST_ASSERT_EQUAL_INT(sizeof(datos), lfs_file_write(&lfs, &file, datos, sizeof(datos)));
+    TEST_ASSERT_EQUAL_INT(0, lfs_file_close(&lfs, &file));
+    TEST_ASSERT_EQUAL_INT(0, lfs_unmount(&lfs));
+
+    TEST_ASSERT_EQUAL_INT(0, lfs_mount(&lfs, &cfg));
+    TEST_ASSERT_EQUAL_INT(0, lfs_file_open(&lfs, &file, "log.txt", LFS_O_RDONLY));
+    TEST_ASSERT_EQUAL_INT(sizeof(datos), lfs_file_read(&lfs, &file, readBuff, sizeof(readBuff)));
+    TEST_ASSERT_EQUAL_INT(0, lfs_file_close(&lfs, &file));
+    TEST_ASSERT_EQUAL_INT(0, lfs_unmount(&lfs));
+
+    TEST_ASSERT_EQUAL_STRING(datos, readBuff);
+}